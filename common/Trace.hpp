@@ -0,0 +1,139 @@
+#pragma once
+
+// Optional trace zones, shared by the plugins. A plugin's build compiles them in by defining
+// TRACE_PREFIX to the plugin's prefix, e.g. -DTRACE_PREFIX=HYPRBARS for make TRACE=1, -DHYPRBARS_TRACE=ON
+// or -Dtrace=true. Zones are written in the Chrome trace event format, which chrome://tracing, Perfetto
+// and Tracy's importer all read, to $<PREFIX>_TRACE_FILE or /tmp/<prefix>-<pid>.trace.json.
+// Timestamps are CLOCK_MONOTONIC, same as the compositor's frame timestamps, so traces of several
+// plugins in the same session line up.
+
+#ifdef TRACE_PREFIX
+
+#include <algorithm>
+#include <cctype>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <format>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#define TRACE_STRINGIFY_(a) #a
+#define TRACE_STRINGIFY(a)  TRACE_STRINGIFY_(a)
+
+namespace Trace {
+    inline uint64_t nowNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
+    class CTraceWriter {
+      public:
+        CTraceWriter() {
+            const auto ENV = getenv(TRACE_STRINGIFY(TRACE_PREFIX) "_TRACE_FILE");
+
+            if (ENV)
+                m_path = ENV;
+            else {
+                std::string name = TRACE_STRINGIFY(TRACE_PREFIX);
+                std::ranges::transform(name, name.begin(), [](unsigned char c) { return std::tolower(c); });
+                m_path = std::format("/tmp/{}-{}.trace.json", name, getpid());
+            }
+
+            m_events.reserve(MAX_BUFFERED);
+        }
+
+        ~CTraceWriter() {
+            flush();
+        }
+
+        void add(const char* name, uint64_t beginNs, uint64_t endNs) {
+            m_events.emplace_back(SEvent{name, beginNs, endNs});
+
+            if (m_events.size() >= MAX_BUFFERED)
+                flush();
+        }
+
+        // the JSON array format doesn't need the closing bracket, so we can append as we go
+        void flush() {
+            if (m_events.empty())
+                return;
+
+            FILE* f = fopen(m_path.c_str(), m_started ? "a" : "w");
+            if (!f)
+                return;
+
+            std::string out = m_started ? "" : "[\n";
+            for (const auto& e : m_events) {
+                if (e.endNs == e.beginNs)
+                    out += std::format(R"({{"name":"{}","ph":"i","s":"g","ts":{:.3f},"pid":{},"tid":{}}},)", e.name, e.beginNs / 1000.0, getpid(), gettid());
+                else
+                    out += std::format(R"({{"name":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":{},"tid":{}}},)", e.name, e.beginNs / 1000.0, (e.endNs - e.beginNs) / 1000.0,
+                                       getpid(), gettid());
+                out += '\n';
+            }
+
+            fwrite(out.data(), 1, out.size(), f);
+            fclose(f);
+
+            m_started = true;
+            m_events.clear();
+        }
+
+      private:
+        struct SEvent {
+            const char* name    = nullptr;
+            uint64_t    beginNs = 0;
+            uint64_t    endNs   = 0;
+        };
+
+        static constexpr size_t MAX_BUFFERED = 16384;
+
+        std::vector<SEvent> m_events;
+        std::string         m_path;
+        bool                m_started = false;
+    };
+
+    inline CTraceWriter& writer() {
+        static CTraceWriter w;
+        return w;
+    }
+
+    class CZone {
+      public:
+        CZone(const char* name) : m_name(name), m_begin(nowNs()) {
+            ;
+        }
+
+        ~CZone() {
+            writer().add(m_name, m_begin, nowNs());
+        }
+
+      private:
+        const char* m_name;
+        uint64_t    m_begin;
+    };
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name)    Trace::CZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_INSTANT(name)                                                                                                                                                        \
+    do {                                                                                                                                                                           \
+        const auto NOW = Trace::nowNs();                                                                                                                                           \
+        Trace::writer().add(name, NOW, NOW);                                                                                                                                       \
+    } while (0)
+#define TRACE_FLUSH() Trace::writer().flush()
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_INSTANT(name)
+#define TRACE_FLUSH()
+
+#endif
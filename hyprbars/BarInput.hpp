@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "BarLayout.hpp"
+
+// What a bar does with a press, a release or a motion: hit testing, the drag state machine and the hover
+// damage decision. Like BarLayout, this has no Hyprland dependency, CHyprBar and the input benchmark both
+// drive it and only differ in how they carry out the actions it returns.
+namespace BarInput {
+    struct SPoint {
+        double x = 0, y = 0;
+    };
+
+    // what a press was on
+    enum ePress : uint8_t {
+        PRESS_OUTSIDE = 0,  // not on the bar, ends a drag of it
+        PRESS_BUTTON,       // run the button's action
+        PRESS_DOUBLE_CLICK, // run on_double_click
+        PRESS_DRAG,         // on the title, the next motion starts a drag
+    };
+
+    // what has to be dispatched to end a drag
+    enum eDragEnd : uint8_t {
+        DRAG_END_NONE  = 0,
+        DRAG_END_MOUSE = (1 << 0), // mouse 0movewindow
+        DRAG_END_TOUCH = (1 << 1), // settiled, touch drags float the window
+    };
+
+    struct SPress {
+        ePress  type    = PRESS_OUTSIDE;
+        int     button  = -1;
+        uint8_t dragEnd = DRAG_END_NONE;
+    };
+
+    struct SRelease {
+        bool    cancel  = false; // the press was taken by the bar, so is the release
+        uint8_t dragEnd = DRAG_END_NONE;
+    };
+
+    constexpr std::chrono::milliseconds DOUBLE_CLICK_DELAY{400}; // Arbitrary delay I found suitable
+
+    class CInputState {
+      public:
+        using clock = std::chrono::steady_clock;
+
+        // a press at pos, relative to the bar. touchID is set for touch downs. T needs a float size member.
+        template <typename T>
+        SPress press(const BarLayout::SGeometry& geo, const std::vector<T>& buttons, const SPoint& pos, std::optional<int> touchID, bool doubleClickAction,
+                     clock::time_point now) {
+            m_touchEv = touchID.has_value();
+            if (m_touchEv)
+                m_touchId = *touchID;
+
+            if (!(pos.x >= 0 && pos.x < geo.barWidth && pos.y >= 0 && pos.y < geo.barHeight - 1)) {
+                const auto DRAGEND = dragEnd();
+
+                m_draggingThis = false;
+                m_dragPending  = false;
+                m_touchEv      = false;
+                m_pendingTouchMove.reset();
+                return {.type = PRESS_OUTSIDE, .dragEnd = DRAGEND};
+            }
+
+            m_cancelledDown = true;
+
+            if (const int BUTTON = BarLayout::buttonAt(geo, buttons, pos.x, pos.y); BUTTON >= 0)
+                return {.type = PRESS_BUTTON, .button = BUTTON};
+
+            if (doubleClickAction && now - m_lastPress < DOUBLE_CLICK_DELAY) {
+                m_dragPending = false;
+                return {.type = PRESS_DOUBLE_CLICK};
+            }
+
+            m_lastPress   = now;
+            m_dragPending = true;
+            return {.type = PRESS_DRAG};
+        }
+
+        SRelease release() {
+            const SRelease RELEASE = {.cancel = m_cancelledDown, .dragEnd = dragEnd()};
+
+            m_cancelledDown = false;
+            m_draggingThis  = false;
+            m_dragPending   = false;
+            m_touchEv       = false;
+            m_touchId       = 0;
+            m_pendingTouchMove.reset();
+            return RELEASE;
+        }
+
+        // true if this motion starts a mouse drag, mouse 1movewindow has to be dispatched then
+        bool startMouseDrag() {
+            if (!m_dragPending || m_touchEv || m_touchId != 0)
+                return false;
+
+            m_dragPending  = false;
+            m_draggingThis = true;
+            return true;
+        }
+
+        // the finger that pressed on the title, its motion and lifting it are ours
+        bool tracksTouch(int touchID) const {
+            return m_dragPending && m_touchEv && touchID == m_touchId;
+        }
+
+        // keeps the latest position for applying once per frame. True for the first one since the last
+        // frame, the bar has to be queued for it then.
+        bool moveTouch(const SPoint& pos) {
+            const bool FIRST   = !m_pendingTouchMove;
+            m_pendingTouchMove = pos;
+            return FIRST;
+        }
+
+        std::optional<SPoint> takeTouchMove() {
+            return std::exchange(m_pendingTouchMove, std::nullopt);
+        }
+
+        // true if the touch drag starts now, the window has to be floated and pinned first then
+        bool beginTouchDrag() {
+            return !std::exchange(m_draggingThis, true);
+        }
+
+        // true if the cursor, at pos relative to the bar, went on or off the buttons. The bar needs a damage then.
+        template <typename T>
+        bool hoverChanged(const BarLayout::SGeometry& geo, const std::vector<T>& buttons, const SPoint& pos) {
+            const bool HOVER = BarLayout::buttonAt(geo, buttons, pos.x, pos.y) >= 0;
+
+            if (HOVER == m_buttonHovered)
+                return false;
+
+            m_buttonHovered = HOVER;
+            return true;
+        }
+
+      private:
+        uint8_t dragEnd() const {
+            if (!m_draggingThis)
+                return DRAG_END_NONE;
+
+            return DRAG_END_MOUSE | (m_touchEv ? DRAG_END_TOUCH : DRAG_END_NONE);
+        }
+
+        bool                  m_draggingThis  = false;
+        bool                  m_touchEv       = false;
+        bool                  m_dragPending   = false;
+        bool                  m_cancelledDown = false;
+        bool                  m_buttonHovered = false;
+        int                   m_touchId       = 0;
+        clock::time_point     m_lastPress     = clock::now();
+
+        // global position of the latest touch motion, not yet applied
+        std::optional<SPoint> m_pendingTouchMove;
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+// Button geometry in bar-local, unscaled coordinates. Like BarRaster, this has no
+// Hyprland dependency so the input benchmark can use the exact same hit testing.
+namespace BarLayout {
+    struct SGeometry {
+        double barWidth      = 0;
+        double barHeight     = 0;
+        double barPadding    = 0;
+        double buttonPadding = 0;
+        bool   buttonsRight  = true;
+    };
+
+    // index of the button under (x, y), or -1. T needs a float size member.
+    template <typename T>
+    int buttonAt(const SGeometry& geo, const std::vector<T>& buttons, const double x, const double y) {
+        const double barW = (int)geo.barWidth;
+
+        float        offset = geo.barPadding;
+        for (size_t i = 0; i < buttons.size(); ++i) {
+            const auto&  b  = buttons[i];
+            const double bx = std::floor(geo.buttonsRight ? barW - geo.buttonPadding - b.size - offset : offset);
+            const double by = std::floor((geo.barHeight - b.size) / 2.0);
+
+            if (x >= bx && x < bx + b.size + geo.buttonPadding && y >= by && y < by + b.size)
+                return i;
+
+            offset += geo.buttonPadding + b.size;
+        }
+
+        return -1;
+    }
+}
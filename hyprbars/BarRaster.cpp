@@ -0,0 +1,292 @@
+#include "BarRaster.hpp"
+
+#include <pango/pangocairo.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// surfaces are allocated in these steps, so sizes that differ by a few pixels share one
+constexpr int    POOL_BUCKET_WIDTH  = 64;
+constexpr int    POOL_BUCKET_HEIGHT = 16;
+// free surfaces kept around, the least recently used one goes when a new one is needed
+constexpr size_t POOL_MAX_SURFACES = 8;
+
+static int roundUp(const int value, const int step) {
+    return (value + step - 1) / step * step;
+}
+
+BarRaster::CSurfacePool::~CSurfacePool() {
+    for (const auto& s : m_surfaces) {
+        cairo_destroy(s->cairo);
+        cairo_surface_destroy(s->surface);
+    }
+
+    m_surfaces.clear();
+    clear();
+}
+
+BarRaster::SPooledSurface* BarRaster::CSurfacePool::acquire(const int width, const int height) {
+    const int       W = std::max(width, 1), H = std::max(height, 1);
+    const long      MAXAREA = 2L * roundUp(W, POOL_BUCKET_WIDTH) * roundUp(H, POOL_BUCKET_HEIGHT);
+
+    SPooledSurface* found = nullptr;
+    for (const auto& s : m_surfaces) {
+        if (s->inUse || s->capacityWidth < W || s->capacityHeight < H)
+            continue;
+
+        // don't hand a full width buttons surface to a small icon
+        const long AREA = (long)s->capacityWidth * s->capacityHeight;
+        if (AREA > MAXAREA || (found && AREA >= (long)found->capacityWidth * found->capacityHeight))
+            continue;
+
+        found = s.get();
+    }
+
+    if (!found) {
+        if (m_surfaces.size() >= POOL_MAX_SURFACES) {
+            SPooledSurface* oldest = nullptr;
+            for (const auto& s : m_surfaces) {
+                if (!s->inUse && (!oldest || s->lastUse < oldest->lastUse))
+                    oldest = s.get();
+            }
+
+            if (oldest)
+                destroy(oldest);
+        }
+
+        auto s            = std::make_unique<SPooledSurface>();
+        s->capacityWidth  = roundUp(W, POOL_BUCKET_WIDTH);
+        s->capacityHeight = roundUp(H, POOL_BUCKET_HEIGHT);
+        s->surface        = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, s->capacityWidth, s->capacityHeight);
+        s->cairo          = cairo_create(s->surface);
+        s->data           = cairo_image_surface_get_data(s->surface);
+        s->stride         = cairo_image_surface_get_stride(s->surface);
+
+        found = m_surfaces.emplace_back(std::move(s)).get();
+    } else if (found->usedWidth > 0 && found->usedHeight > 0) {
+        // new surfaces come zeroed, reused ones only need what the last user drew to and we hand out
+        const int CLEARW = std::min(found->usedWidth, W), CLEARH = std::min(found->usedHeight, H);
+
+        cairo_surface_flush(found->surface);
+        for (int y = 0; y < CLEARH; ++y) {
+            memset(found->data + (size_t)y * found->stride, 0, (size_t)CLEARW * 4);
+        }
+        cairo_surface_mark_dirty_rectangle(found->surface, 0, 0, CLEARW, CLEARH);
+    }
+
+    found->width   = W;
+    found->height  = H;
+    found->inUse   = true;
+    found->lastUse = ++m_useCounter;
+
+    // drawing is clipped to W x H, but what earlier users drew outside of it is still there
+    // and has to be cleared when a bigger request comes in
+    found->usedWidth  = std::max(found->usedWidth, W);
+    found->usedHeight = std::max(found->usedHeight, H);
+
+    cairo_save(found->cairo);
+    cairo_rectangle(found->cairo, 0, 0, W, H);
+    cairo_clip(found->cairo);
+
+    return found;
+}
+
+void BarRaster::CSurfacePool::release(SPooledSurface* surface) {
+    cairo_restore(surface->cairo);
+    cairo_new_path(surface->cairo);
+
+    surface->inUse = false;
+}
+
+void BarRaster::CSurfacePool::destroy(SPooledSurface* surface) {
+    cairo_destroy(surface->cairo);
+    cairo_surface_destroy(surface->surface);
+    std::erase_if(m_surfaces, [surface](const auto& s) { return s.get() == surface; });
+}
+
+cairo_t* BarRaster::CSurfacePool::scratchContext() {
+    if (!m_scratch) {
+        m_scratchSurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+        m_scratch        = cairo_create(m_scratchSurface);
+    }
+
+    return m_scratch;
+}
+
+void BarRaster::CSurfacePool::clear() {
+    std::vector<SPooledSurface*> unused;
+    for (const auto& s : m_surfaces) {
+        if (!s->inUse)
+            unused.emplace_back(s.get());
+    }
+
+    for (const auto s : unused) {
+        destroy(s);
+    }
+
+    if (m_scratch) {
+        cairo_destroy(m_scratch);
+        cairo_surface_destroy(m_scratchSurface);
+        m_scratch        = nullptr;
+        m_scratchSurface = nullptr;
+    }
+}
+
+size_t BarRaster::CSurfacePool::size() const {
+    return m_surfaces.size();
+}
+
+size_t BarRaster::CSurfacePool::bytes() const {
+    size_t bytes = 0;
+    for (const auto& s : m_surfaces) {
+        bytes += (size_t)s->stride * s->capacityHeight;
+    }
+    return bytes;
+}
+
+BarRaster::CTitleLayout::CTitleLayout(cairo_t* cr, const STitle& title, const int maxWidth) {
+    m_layout = pango_cairo_create_layout(cr);
+    pango_layout_set_text(m_layout, title.text.c_str(), -1);
+
+    PangoFontDescription* fontDesc = pango_font_description_from_string(title.font.c_str());
+    pango_font_description_set_size(fontDesc, title.fontSize * PANGO_SCALE);
+    pango_layout_set_font_description(m_layout, fontDesc);
+    pango_font_description_free(fontDesc);
+
+    PangoContext* context = pango_layout_get_context(m_layout);
+    pango_context_set_base_dir(context, PANGO_DIRECTION_NEUTRAL);
+
+    pango_layout_set_width(m_layout, maxWidth * PANGO_SCALE);
+    pango_layout_set_ellipsize(m_layout, PANGO_ELLIPSIZE_END);
+
+    int layoutWidth, layoutHeight;
+    pango_layout_get_size(m_layout, &layoutWidth, &layoutHeight);
+    width      = layoutWidth / PANGO_SCALE;
+    height     = layoutHeight / PANGO_SCALE;
+    ellipsized = pango_layout_is_ellipsized(m_layout);
+
+    PangoRectangle ink, logical;
+    pango_layout_get_pixel_extents(m_layout, &ink, &logical);
+    rasterX      = std::min(ink.x, logical.x);
+    rasterY      = std::min(ink.y, logical.y);
+    rasterWidth  = std::max(ink.x + ink.width, logical.x + logical.width) - rasterX;
+    rasterHeight = std::max(ink.y + ink.height, logical.y + logical.height) - rasterY;
+
+    naturalWidth = width;
+    if (ellipsized) {
+        // only needed to tell when a resize makes the ellipsis go away
+        pango_layout_set_width(m_layout, -1);
+        pango_layout_get_size(m_layout, &layoutWidth, nullptr);
+        naturalWidth = layoutWidth / PANGO_SCALE;
+        pango_layout_set_width(m_layout, maxWidth * PANGO_SCALE);
+    }
+}
+
+BarRaster::CTitleLayout::~CTitleLayout() {
+    g_object_unref(m_layout);
+}
+
+void BarRaster::CTitleLayout::render(cairo_t* cr, const double x, const double y) const {
+    cairo_move_to(cr, x, y);
+    pango_cairo_show_layout(cr, m_layout);
+}
+
+void BarRaster::CTitleLayout::glyphs(std::vector<SShapedGlyph>& out) const {
+    out.clear();
+
+    PangoLayoutIter* iter = pango_layout_get_iter(m_layout);
+
+    do {
+        const PangoGlyphItem* RUN = pango_layout_iter_get_run_readonly(iter);
+
+        // the end of a line
+        if (!RUN)
+            continue;
+
+        PangoRectangle logical;
+        pango_layout_iter_get_run_extents(iter, nullptr, &logical);
+
+        const int BASELINE = pango_layout_iter_get_baseline(iter);
+        int       x        = logical.x;
+
+        for (int i = 0; i < RUN->glyphs->num_glyphs; ++i) {
+            const auto& G = RUN->glyphs->glyphs[i];
+
+            if (G.glyph != PANGO_GLYPH_EMPTY && !(G.glyph & PANGO_GLYPH_UNKNOWN_FLAG))
+                out.emplace_back(SShapedGlyph{.font  = RUN->item->analysis.font,
+                                              .glyph = G.glyph,
+                                              .x     = (double)(x + G.geometry.x_offset) / PANGO_SCALE,
+                                              .y     = (double)(BASELINE + G.geometry.y_offset) / PANGO_SCALE});
+
+            x += G.geometry.width;
+        }
+    } while (pango_layout_iter_next_run(iter));
+
+    pango_layout_iter_free(iter);
+}
+
+int BarRaster::titleMaxWidth(const int width, const STitle& title) {
+    const int paddingTotal = title.barPadding * 2 + title.buttonsWidth + (!title.alignLeft ? title.buttonsWidth : 0);
+    return std::clamp(static_cast<int>(width - paddingTotal), 0, INT_MAX);
+}
+
+std::pair<int, int> BarRaster::titleOffset(const int width, const int height, const STitle& title, const int textWidth, const int textHeight) {
+    const int xOffset = title.alignLeft ? std::round(title.barPadding + (title.buttonsRight ? 0 : title.buttonsWidth)) :
+                                          std::round(((width - title.borderSize) / 2.0 - textWidth / 2.0));
+    const int yOffset = std::round((height / 2.0 - textHeight / 2.0));
+
+    return {xOffset, yOffset};
+}
+
+void BarRaster::renderTitle(cairo_t* cr, const int width, const int height, const STitle& title) {
+    const CTitleLayout LAYOUT(cr, title, titleMaxWidth(width, title));
+    const auto [X, Y] = titleOffset(width, height, title, LAYOUT.width, LAYOUT.height);
+
+    cairo_set_source_rgba(cr, title.color.r, title.color.g, title.color.b, title.color.a);
+    LAYOUT.render(cr, X, Y);
+}
+
+void BarRaster::renderText(cairo_t* cr, const int width, const int height, const std::string& text, const SColor& color, const double fontSize) {
+    PangoLayout* layout = pango_cairo_create_layout(cr);
+    pango_layout_set_text(layout, text.c_str(), -1);
+
+    PangoFontDescription* fontDesc = pango_font_description_from_string("sans");
+    pango_font_description_set_size(fontDesc, fontSize * PANGO_SCALE);
+    pango_layout_set_font_description(layout, fontDesc);
+    pango_font_description_free(fontDesc);
+
+    pango_layout_set_width(layout, width * PANGO_SCALE);
+    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_NONE);
+
+    cairo_set_source_rgba(cr, color.r, color.g, color.b, color.a);
+
+    PangoRectangle ink_rect, logical_rect;
+    pango_layout_get_extents(layout, &ink_rect, &logical_rect);
+
+    const int    layoutWidth  = ink_rect.width;
+    const int    layoutHeight = logical_rect.height;
+
+    const double xOffset = (width / 2.0 - layoutWidth / PANGO_SCALE / 2.0);
+    const double yOffset = (height / 2.0 - layoutHeight / PANGO_SCALE / 2.0);
+
+    cairo_move_to(cr, xOffset, yOffset);
+    pango_cairo_show_layout(cr, layout);
+
+    g_object_unref(layout);
+}
+
+void BarRaster::renderButtons(cairo_t* cr, const int width, const int height, const SButtons& buttons) {
+    int offset = buttons.barPadding;
+    for (const auto& button : buttons.buttons) {
+        const double x = std::floor(buttons.right ? width - offset - button.size / 2.0 : offset + button.size / 2.0);
+        const double y = std::floor(height / 2.0);
+
+        cairo_set_source_rgba(cr, button.color.r, button.color.g, button.color.b, button.color.a);
+        cairo_arc(cr, x, y, button.size / 2, 0, 2 * M_PI);
+        cairo_fill(cr);
+
+        offset += buttons.buttonPadding + button.size;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cairo/cairo.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef struct _PangoLayout PangoLayout;
+typedef struct _PangoFont   PangoFont;
+
+// The cairo / Pango side of drawing a bar. Nothing here may depend on Hyprland,
+// the benchmarks in bench/ link this without a compositor or a GPU.
+// All sizes are in buffer pixels, i.e. already multiplied by the monitor scale.
+namespace BarRaster {
+    struct SColor {
+        double r = 0, g = 0, b = 0, a = 0;
+    };
+
+    struct STitle {
+        std::string text;
+        std::string font         = "Sans";
+        double      fontSize     = 10;
+        SColor      color;
+        bool        alignLeft    = false;
+        bool        buttonsRight = true;
+        double      barPadding   = 0;
+        double      buttonsWidth = 0; // space taken by the buttons, including their padding
+        double      borderSize   = 0;
+    };
+
+    struct SButton {
+        double size = 10;
+        SColor color;
+    };
+
+    struct SButtons {
+        std::vector<SButton> buttons; // only the visible ones
+        double               barPadding    = 0;
+        double               buttonPadding = 0;
+        bool                 right         = true;
+    };
+
+    // a glyph of a laid out title, at its baseline origin relative to the layout origin
+    struct SShapedGlyph {
+        PangoFont* font  = nullptr; // owned by the layout
+        uint32_t   glyph = 0;
+        double     x = 0, y = 0;
+    };
+
+    // A title shaped and measured before anything is drawn, so it can be rasterized into a texture
+    // that's just big enough for the text and placed in the bar separately, see titleOffset.
+    class CTitleLayout {
+      public:
+        // cr only has to have the font options of the surface it's drawn to, see CSurfacePool::scratchContext
+        CTitleLayout(cairo_t* cr, const STitle& title, const int maxWidth);
+        ~CTitleLayout();
+
+        CTitleLayout(const CTitleLayout&)            = delete;
+        CTitleLayout& operator=(const CTitleLayout&) = delete;
+
+        // draws the text with the layout origin at x, y
+        void render(cairo_t* cr, const double x, const double y) const;
+
+        // the shaped glyphs in visual order, ellipsis included. Glyphs Pango has no font for are left out.
+        void glyphs(std::vector<SShapedGlyph>& out) const;
+
+        int  width        = 0; // laid out size
+        int  height       = 0;
+        int  naturalWidth = 0; // width without the ellipsis
+        bool ellipsized   = false;
+
+        // area that has to be rasterized, relative to the layout origin. Includes the ink
+        // sticking out of the logical size, e.g. italic overhangs.
+        int rasterX = 0, rasterY = 0, rasterWidth = 0, rasterHeight = 0;
+
+      private:
+        PangoLayout* m_layout = nullptr;
+    };
+
+    // A surface handed out by CSurfacePool. Only the top left width x height is yours: it's clear
+    // when acquired and the context is clipped to it. The surface itself may be bigger, see stride.
+    struct SPooledSurface {
+        cairo_surface_t* surface = nullptr;
+        cairo_t*         cairo   = nullptr;
+        unsigned char*   data    = nullptr;
+        int              stride  = 0;
+        int              width = 0, height = 0;
+
+        // pool bookkeeping
+        int      capacityWidth = 0, capacityHeight = 0;
+        int      usedWidth = 0, usedHeight = 0; // bounding box of what may not be clear
+        bool     inUse   = false;
+        uint64_t lastUse = 0;
+    };
+
+    // Keeps a few image surfaces around so rasterizing doesn't allocate and clear a whole surface
+    // every time. Surfaces are sized in buckets and reused for anything that fits and isn't much
+    // smaller, and only the part the previous user drew to is cleared.
+    class CSurfacePool {
+      public:
+        ~CSurfacePool();
+
+        SPooledSurface* acquire(const int width, const int height);
+        void            release(SPooledSurface* surface);
+
+        // a 1x1 context with the same font options as the pooled surfaces, for laying titles out
+        cairo_t*        scratchContext();
+
+        // frees the surfaces not in use and the scratch context
+        void            clear();
+
+        size_t          size() const;
+        size_t          bytes() const;
+
+      private:
+        std::vector<std::unique_ptr<SPooledSurface>> m_surfaces;
+        uint64_t                                     m_useCounter     = 0;
+        cairo_surface_t*                             m_scratchSurface = nullptr;
+        cairo_t*                                     m_scratch        = nullptr;
+
+        void                                         destroy(SPooledSurface* surface);
+    };
+
+    // width the title text may take in a bar of the given width
+    int                 titleMaxWidth(const int width, const STitle& title);
+    // where the layout origin of a title of the given size goes in a bar of the given size
+    std::pair<int, int> titleOffset(const int width, const int height, const STitle& title, const int textWidth, const int textHeight);
+
+    void                renderTitle(cairo_t* cr, const int width, const int height, const STitle& title);
+    void                renderText(cairo_t* cr, const int width, const int height, const std::string& text, const SColor& color, const double fontSize);
+    void                renderButtons(cairo_t* cr, const int width, const int height, const SButtons& buttons);
+}
@@ -0,0 +1,126 @@
+#include "ButtonSet.hpp"
+
+#include <hyprland/src/helpers/MiscFunctions.hpp>
+#include <hyprland/src/debug/Log.hpp>
+#include <hyprutils/string/String.hpp>
+
+using namespace Hyprutils::String;
+
+std::expected<SBarAction, std::string> parseBarAction(const std::string& action) {
+    constexpr std::string_view DISPATCH = "dispatch:";
+    constexpr std::string_view HYPRCTL  = "hyprctl dispatch ";
+
+    const auto                 ACTION = trim(action);
+
+    if (ACTION.empty())
+        return SBarAction{};
+
+    // the split between dispatcher and arg is the same hyprctl dispatch uses
+    const auto SPLIT = [](const std::string& str) -> SBarAction {
+        const auto SPACE = str.find_first_of(" \t");
+        if (SPACE == std::string::npos)
+            return {str, ""};
+        return {str.substr(0, SPACE), trim(str.substr(SPACE + 1))};
+    };
+
+    if (ACTION.starts_with(DISPATCH)) {
+        auto parsed = SPLIT(trim(ACTION.substr(DISPATCH.length())));
+        if (parsed.dispatcher.empty())
+            return std::unexpected("dispatch: needs a dispatcher");
+        return parsed;
+    }
+
+    // configs from before dispatch: existed. Plain "hyprctl dispatch" commands are taken over, anything
+    // that needs a shell to mean what it says is left to the shell.
+    if (ACTION.starts_with(HYPRCTL) && ACTION.find_first_of(";&|<>$`'\"\\(){}*?~#") == std::string::npos) {
+        auto parsed = SPLIT(trim(ACTION.substr(HYPRCTL.length())));
+        if (!parsed.dispatcher.empty() && !parsed.dispatcher.starts_with('-'))
+            return parsed;
+    }
+
+    return SBarAction{"exec", ACTION};
+}
+
+std::expected<SHyprButton, std::string> parseHyprButton(const std::vector<std::string>& args) {
+    const auto ARG = [&args](size_t i) -> std::string { return i < args.size() ? args[i] : ""; };
+
+    if (ARG(0).empty() || ARG(1).empty())
+        return std::unexpected("bgcolor and size cannot be empty");
+
+    float size = 10;
+    try {
+        size = std::stof(ARG(1));
+    } catch (std::exception& e) { return std::unexpected("failed to parse size"); }
+
+    bool userfg  = false;
+    auto fgcolor = configStringToInt("rgb(ffffff)");
+    auto bgcolor = configStringToInt(ARG(0));
+
+    if (!bgcolor)
+        return std::unexpected("invalid bgcolor");
+
+    if (args.size() == 5) {
+        userfg  = true;
+        fgcolor = configStringToInt(ARG(4));
+    }
+
+    if (!fgcolor)
+        return std::unexpected("invalid fgcolor");
+
+    auto action = parseBarAction(ARG(3));
+
+    if (!action)
+        return std::unexpected(action.error());
+
+    return SHyprButton{*action, userfg, *fgcolor, *bgcolor, size, ARG(2)};
+}
+
+static std::vector<std::string> splitRuleDefinition(const std::string& def) {
+    constexpr std::string_view DELIM = ">|<";
+
+    std::vector<std::string>   out;
+    size_t                     start = 0, end = 0;
+    while ((end = def.find(DELIM, start)) != std::string::npos) {
+        out.emplace_back(def.substr(start, end - start));
+        start = end + DELIM.length();
+    }
+    out.emplace_back(def.substr(start));
+
+    return out;
+}
+
+SP<const SButtonSet> internButtonSet(const std::vector<std::string>& definitions) {
+    std::string key;
+    for (const auto& d : definitions) {
+        key += d;
+        key += '\n';
+    }
+
+    auto& sets = g_pGlobalState->buttonSets;
+
+    if (const auto IT = sets.find(key); IT != sets.end()) {
+        if (const auto SET = IT->second.lock())
+            return SET;
+    }
+
+    // drop sets no bar holds anymore before adding a new one
+    std::erase_if(sets, [](const auto& e) { return e.second.expired(); });
+
+    auto set = makeShared<SButtonSet>();
+    for (const auto& d : definitions) {
+        auto button = parseHyprButton(splitRuleDefinition(d));
+
+        if (!button) {
+            Debug::log(ERR, "[hyprbars] invalid hyprbars-button rule \"{}\": {}", d, button.error());
+            continue;
+        }
+
+        set->buttonsWidth += button->size;
+        set->buttons.emplace_back(std::move(*button));
+    }
+
+    SP<const SButtonSet> shared = set;
+    sets[key]                   = shared;
+
+    return shared;
+}
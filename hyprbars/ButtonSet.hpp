@@ -0,0 +1,17 @@
+#pragma once
+
+#include <expected>
+#include <string>
+#include <vector>
+
+#include "globals.hpp"
+
+// parses a button or double click action, see SBarAction
+std::expected<SBarAction, std::string> parseBarAction(const std::string& action);
+
+// parses a button definition: bgcolor, size, icon, action[, fgcolor]
+std::expected<SHyprButton, std::string> parseHyprButton(const std::vector<std::string>& args);
+
+// returns the shared set for the given button rule definitions, creating it if no bar uses it yet.
+// Each definition is one hyprbars-button rule argument, with the fields delimited by ">|<".
+SP<const SButtonSet> internButtonSet(const std::vector<std::string>& definitions);
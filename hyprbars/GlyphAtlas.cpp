@@ -0,0 +1,261 @@
+#include "GlyphAtlas.hpp"
+
+#include <pango/pangocairo.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// one page holds a few hundred glyphs at the smaller bucket, more than a screen of titles needs
+constexpr int                PAGE_SIZE = 1024;
+// how far the field reaches on each side of an edge, in bucket pixels. Also the padding around every glyph.
+constexpr int                SPREAD = 4;
+// glyphs are rasterized at the smallest bucket at least as big as the font, or the biggest one
+constexpr std::array<int, 2> BUCKETS = {32, 64};
+
+// Turns a coverage mask into a signed distance field, 0.5 being the edge. Partly covered pixels
+// are on the edge already and take their coverage, the others the distance to the closest pixel
+// on the other side. Only done once per glyph, so a plain search is fine.
+static void distanceField(const uint8_t* coverage, const int stride, const int w, const int h, uint8_t* out, const int outStride) {
+    const auto INSIDE = [&](int x, int y) { return x >= 0 && y >= 0 && x < w && y < h && coverage[(size_t)y * stride + x] >= 128; };
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const float C = coverage[(size_t)y * stride + x] / 255.F;
+            float       distance;
+
+            if (C > 0.F && C < 1.F)
+                distance = C - 0.5F;
+            else {
+                const bool IN      = C >= 1.F;
+                int        nearest = SPREAD * SPREAD;
+
+                for (int dy = -SPREAD; dy <= SPREAD; ++dy) {
+                    for (int dx = -SPREAD; dx <= SPREAD; ++dx) {
+                        if (INSIDE(x + dx, y + dy) != IN)
+                            nearest = std::min(nearest, dx * dx + dy * dy);
+                    }
+                }
+
+                distance = std::min<float>(std::sqrt((float)nearest) - 0.5F, SPREAD);
+                distance = IN ? distance : -distance;
+            }
+
+            out[(size_t)y * outStride + x] = std::lround(std::clamp(0.5F + distance / (2 * SPREAD), 0.F, 1.F) * 255);
+        }
+    }
+}
+
+BarRaster::CGlyphAtlas::CGlyphAtlas() {
+    m_pixels.resize((size_t)PAGE_SIZE * PAGE_SIZE, 0);
+    m_context = pango_font_map_create_context(pango_cairo_font_map_get_default());
+}
+
+BarRaster::CGlyphAtlas::~CGlyphAtlas() {
+    for (auto& [font, info] : m_fonts) {
+        g_object_unref(font);
+    }
+
+    for (auto& [key, font] : m_bucketFonts) {
+        if (font)
+            g_object_unref(font);
+    }
+
+    for (auto& desc : m_faces) {
+        pango_font_description_free(desc);
+    }
+
+    g_object_unref(m_context);
+}
+
+void BarRaster::CGlyphAtlas::layout(const CTitleLayout& layout, std::vector<SGlyphQuad>& out) {
+    layout.glyphs(m_shaped);
+
+    out.clear();
+
+    for (const auto& shaped : m_shaped) {
+        const auto   FONT   = fontFor(shaped.font);
+        const int    BUCKET = FONT.pixelSize <= BUCKETS[0] ? BUCKETS[0] : BUCKETS[1];
+        const auto&  G      = glyph(FONT, shaped.glyph, BUCKET);
+        const double SCALE  = FONT.pixelSize / BUCKET;
+
+        if (G.w == 0)
+            continue;
+
+        out.emplace_back(SGlyphQuad{
+            .x  = (float)(shaped.x + G.bearingX * SCALE),
+            .y  = (float)(shaped.y + G.bearingY * SCALE),
+            .w  = (float)(G.w * SCALE),
+            .h  = (float)(G.h * SCALE),
+            .u0 = (float)G.x / PAGE_SIZE,
+            .v0 = (float)G.y / PAGE_SIZE,
+            .u1 = (float)(G.x + G.w) / PAGE_SIZE,
+            .v1 = (float)(G.y + G.h) / PAGE_SIZE,
+        });
+    }
+}
+
+BarRaster::CGlyphAtlas::SFont BarRaster::CGlyphAtlas::fontFor(PangoFont* font) {
+    if (const auto IT = m_fonts.find(font); IT != m_fonts.end())
+        return IT->second;
+
+    // glyph ids belong to the face, the size only decides the bucket
+    PangoFontDescription* desc = pango_font_describe_with_absolute_size(font);
+    const double          PX   = (double)pango_font_description_get_size(desc) / PANGO_SCALE;
+    pango_font_description_unset_fields(desc, PANGO_FONT_MASK_SIZE);
+
+    char*             str = pango_font_description_to_string(desc);
+    const std::string KEY = str;
+    g_free(str);
+
+    auto [it, inserted] = m_faceIds.emplace(KEY, (uint32_t)m_faces.size());
+    if (inserted)
+        m_faces.emplace_back(desc);
+    else
+        pango_font_description_free(desc);
+
+    // held on to, a font freed and another one allocated at the same address would get its face
+    g_object_ref(font);
+
+    return m_fonts.emplace(font, SFont{.face = it->second, .pixelSize = PX}).first->second;
+}
+
+PangoFont* BarRaster::CGlyphAtlas::bucketFont(uint32_t face, int bucket) {
+    const uint64_t KEY = ((uint64_t)face << 32) | (uint32_t)bucket;
+
+    if (const auto IT = m_bucketFonts.find(KEY); IT != m_bucketFonts.end())
+        return IT->second;
+
+    PangoFontDescription* desc = pango_font_description_copy(m_faces[face]);
+    pango_font_description_set_absolute_size(desc, bucket * PANGO_SCALE);
+
+    PangoFont* font = pango_font_map_load_font(pango_cairo_font_map_get_default(), m_context, desc);
+    pango_font_description_free(desc);
+
+    return m_bucketFonts.emplace(KEY, font).first->second;
+}
+
+const BarRaster::CGlyphAtlas::SGlyph& BarRaster::CGlyphAtlas::glyph(const SFont& font, uint32_t glyph, int bucket) {
+    const uint64_t KEY = ((uint64_t)font.face << 40) | ((uint64_t)bucket << 32) | glyph;
+
+    if (const auto IT = m_glyphs.find(KEY); IT != m_glyphs.end())
+        return IT->second;
+
+    SGlyph         entry;
+    const auto     PFONT = bucketFont(font.face, bucket);
+
+    PangoRectangle ink = {};
+    if (PFONT) {
+        pango_font_get_glyph_extents(PFONT, glyph, &ink, nullptr);
+        pango_extents_to_pixels(&ink, nullptr);
+    }
+
+    // spaces and the like have nothing to draw
+    if (ink.width <= 0 || ink.height <= 0)
+        return m_glyphs.emplace(KEY, entry).first->second;
+
+    const int W = ink.width + 2 * SPREAD, H = ink.height + 2 * SPREAD;
+
+    int       x = 0, y = 0;
+    if (!place(W, H, x, y)) {
+        reset();
+
+        // bigger than a whole page, not drawn. Not kept either, it's tried again after the next reset.
+        if (!place(W, H, x, y)) {
+            static const SGlyph NONE;
+            return NONE;
+        }
+    }
+
+    const int STRIDE = cairo_format_stride_for_width(CAIRO_FORMAT_A8, W);
+    m_scratch.assign((size_t)STRIDE * H, 0);
+
+    cairo_surface_t*  surface = cairo_image_surface_create_for_data(m_scratch.data(), CAIRO_FORMAT_A8, W, H, STRIDE);
+    cairo_t*          cr      = cairo_create(surface);
+
+    PangoGlyphString* glyphs = pango_glyph_string_new();
+    pango_glyph_string_set_size(glyphs, 1);
+    glyphs->glyphs[0]                       = {};
+    glyphs->glyphs[0].glyph                 = glyph;
+    glyphs->glyphs[0].attr.is_cluster_start = 1;
+
+    cairo_move_to(cr, SPREAD - ink.x, SPREAD - ink.y);
+    pango_cairo_show_glyph_string(cr, PFONT, glyphs);
+
+    pango_glyph_string_free(glyphs);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    cairo_surface_destroy(surface);
+
+    distanceField(m_scratch.data(), STRIDE, W, H, m_pixels.data() + (size_t)y * PAGE_SIZE + x, PAGE_SIZE);
+
+    m_dirtyFirst = m_dirtyLast > m_dirtyFirst ? std::min(m_dirtyFirst, y) : y;
+    m_dirtyLast  = std::max(m_dirtyLast, y + H);
+
+    entry = {.x = x, .y = y, .w = W, .h = H, .bearingX = (float)(ink.x - SPREAD), .bearingY = (float)(ink.y - SPREAD)};
+
+    return m_glyphs.emplace(KEY, entry).first->second;
+}
+
+bool BarRaster::CGlyphAtlas::place(int w, int h, int& x, int& y) {
+    // shelves: left to right, and a new row below the tallest glyph when one doesn't fit anymore.
+    // A pixel is left between glyphs so filtering doesn't pick up the neighbor.
+    if (m_shelfX + w > PAGE_SIZE) {
+        m_shelfY += m_shelfHeight;
+        m_shelfX      = 0;
+        m_shelfHeight = 0;
+    }
+
+    if (m_shelfY + h > PAGE_SIZE)
+        return false;
+
+    x = m_shelfX;
+    y = m_shelfY;
+
+    m_shelfX += w + 1;
+    m_shelfHeight = std::max(m_shelfHeight, h + 1);
+
+    return true;
+}
+
+void BarRaster::CGlyphAtlas::reset() {
+    std::ranges::fill(m_pixels, 0);
+    m_glyphs.clear();
+
+    m_shelfX      = 0;
+    m_shelfY      = 0;
+    m_shelfHeight = 0;
+    m_dirtyFirst  = 0;
+    m_dirtyLast   = PAGE_SIZE;
+
+    m_epoch++;
+}
+
+uint64_t BarRaster::CGlyphAtlas::epoch() const {
+    return m_epoch;
+}
+
+const uint8_t* BarRaster::CGlyphAtlas::pixels() const {
+    return m_pixels.data();
+}
+
+int BarRaster::CGlyphAtlas::size() const {
+    return PAGE_SIZE;
+}
+
+std::pair<int, int> BarRaster::CGlyphAtlas::takeDirtyRows() {
+    const std::pair<int, int> ROWS = {m_dirtyFirst, m_dirtyLast};
+
+    m_dirtyFirst = 0;
+    m_dirtyLast  = 0;
+
+    return ROWS;
+}
+
+size_t BarRaster::CGlyphAtlas::glyphCount() const {
+    return m_glyphs.size();
+}
+
+size_t BarRaster::CGlyphAtlas::bytes() const {
+    return m_pixels.size();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "BarRaster.hpp"
+
+typedef struct _PangoContext         PangoContext;
+typedef struct _PangoFontDescription PangoFontDescription;
+
+// Glyphs rasterized once as signed distance fields into a single channel page shared by every title,
+// for text_engine = atlas. A distance field scales, so a face is rasterized at one of a couple of
+// bucket sizes only and drawn at any size and scale from it.
+// Like BarRaster, nothing here depends on Hyprland.
+namespace BarRaster {
+    // a glyph to draw, in buffer pixels relative to the layout origin, and where it is in the atlas
+    struct SGlyphQuad {
+        float x = 0, y = 0, w = 0, h = 0;
+        float u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+    };
+
+    class CGlyphAtlas {
+      public:
+        CGlyphAtlas();
+        ~CGlyphAtlas();
+
+        CGlyphAtlas(const CGlyphAtlas&)            = delete;
+        CGlyphAtlas& operator=(const CGlyphAtlas&) = delete;
+
+        // the glyphs of a laid out title, rasterizing the ones the atlas doesn't have yet.
+        // Quads are only valid as long as epoch() doesn't change, that includes during the call:
+        // the page may fill up and start over halfway through the title.
+        void layout(const CTitleLayout& layout, std::vector<SGlyphQuad>& out);
+
+        // bumped when the page was full and started over, every title has to be laid out again
+        uint64_t       epoch() const;
+
+        const uint8_t* pixels() const;
+        int            size() const;
+        // rows changed since the last call, as [first, last), empty if none
+        std::pair<int, int> takeDirtyRows();
+
+        size_t              glyphCount() const;
+        size_t              bytes() const;
+
+      private:
+        struct SGlyph {
+            int   x = 0, y = 0, w = 0, h = 0; // in the page, 0 wide for glyphs without ink
+            float bearingX = 0, bearingY = 0; // top left of the field relative to the glyph origin, bucket pixels
+        };
+
+        struct SFont {
+            uint32_t face      = 0;
+            double   pixelSize = 0;
+        };
+
+        const SGlyph&                             glyph(const SFont& font, uint32_t glyph, int bucket);
+        bool                                      place(int w, int h, int& x, int& y);
+        void                                      reset();
+        SFont                                     fontFor(PangoFont* font);
+        PangoFont*                                bucketFont(uint32_t face, int bucket);
+
+        std::vector<uint8_t>                      m_pixels;
+        int                                       m_shelfX      = 0;
+        int                                       m_shelfY      = 0;
+        int                                       m_shelfHeight = 0;
+        int                                       m_dirtyFirst  = 0;
+        int                                       m_dirtyLast   = 0;
+        uint64_t                                  m_epoch       = 1;
+
+        std::unordered_map<uint64_t, SGlyph>      m_glyphs; // by face, bucket and glyph id
+        std::unordered_map<PangoFont*, SFont>     m_fonts;  // the fonts layouts used, referenced
+        std::unordered_map<std::string, uint32_t> m_faceIds;
+        std::vector<PangoFontDescription*>        m_faces; // by face id, without a size
+        std::unordered_map<uint64_t, PangoFont*>  m_bucketFonts;
+        PangoContext*                             m_context = nullptr;
+
+        std::vector<SShapedGlyph>                 m_shaped;
+        std::vector<uint8_t>                      m_scratch; // a glyph before it becomes a distance field
+    };
+}
@@ -0,0 +1,206 @@
+#include "GlyphRenderer.hpp"
+
+#include <hyprland/src/render/Renderer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+// instanced draws, R8 textures and GLSL ES 3 aren't there on GLES2, ok() stays false and titles go through Pango
+#ifndef GLES2
+
+// glyph rects are relative to the layout origin and in layout pixels, place moves and scales them into
+// the framebuffer and proj maps box to the unit square like for Hyprland's own quads
+static const std::string VERT = R"#(#version 300 es
+precision highp float;
+
+uniform mat3 proj;
+uniform vec4 box;
+uniform vec3 place;
+
+in vec2 corner;
+in vec4 rect;
+in vec4 uv;
+
+out vec2 v_uv;
+
+void main() {
+    vec2 pos    = place.xy + (rect.xy + corner * rect.zw) * place.z;
+    v_uv        = mix(uv.xy, uv.zw, corner);
+    gl_Position = vec4(proj * vec3((pos - box.xy) / box.zw, 1.0), 1.0);
+}
+)#";
+
+// 0.5 is the edge, smoothed over about a pixel whatever the glyph is scaled to
+static const std::string FRAG = R"#(#version 300 es
+precision highp float;
+
+uniform sampler2D atlas;
+uniform vec4      color;
+
+in vec2 v_uv;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    float d = texture(atlas, v_uv).r;
+    float w = max(fwidth(d) * 0.7, 0.001);
+    fragColor = color * smoothstep(0.5 - w, 0.5 + w, d);
+}
+)#";
+
+#endif
+
+CGlyphRenderer::CGlyphRenderer() {
+#ifdef GLES2
+    Debug::log(ERR, "[hyprbars] text_engine = atlas needs GLES3, falling back to pango titles");
+#else
+    m_program = g_pHyprOpenGL->createProgram(VERT, FRAG, true);
+
+    if (!m_program) {
+        Debug::log(ERR, "[hyprbars] glyph atlas shader failed to compile, falling back to pango titles");
+        return;
+    }
+
+    m_loc = {
+        .proj   = glGetUniformLocation(m_program, "proj"),
+        .box    = glGetUniformLocation(m_program, "box"),
+        .place  = glGetUniformLocation(m_program, "place"),
+        .color  = glGetUniformLocation(m_program, "color"),
+        .atlas  = glGetUniformLocation(m_program, "atlas"),
+        .corner = glGetAttribLocation(m_program, "corner"),
+        .rect   = glGetAttribLocation(m_program, "rect"),
+        .uv     = glGetAttribLocation(m_program, "uv"),
+    };
+
+    static constexpr std::array<GLfloat, 8> CORNERS = {0, 0, 1, 0, 0, 1, 1, 1};
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+
+    glGenBuffers(1, &m_cornerVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_cornerVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CORNERS), CORNERS.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(m_loc.corner);
+    glVertexAttribPointer(m_loc.corner, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    // one SGlyphQuad per instance, as is
+    glGenBuffers(1, &m_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    glEnableVertexAttribArray(m_loc.rect);
+    glVertexAttribPointer(m_loc.rect, 4, GL_FLOAT, GL_FALSE, sizeof(BarRaster::SGlyphQuad), (void*)offsetof(BarRaster::SGlyphQuad, x));
+    glVertexAttribDivisor(m_loc.rect, 1);
+    glEnableVertexAttribArray(m_loc.uv);
+    glVertexAttribPointer(m_loc.uv, 4, GL_FLOAT, GL_FALSE, sizeof(BarRaster::SGlyphQuad), (void*)offsetof(BarRaster::SGlyphQuad, u0));
+    glVertexAttribDivisor(m_loc.uv, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const int SIZE = m_atlas.size();
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, SIZE, SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, m_atlas.pixels());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_atlas.takeDirtyRows();
+#endif
+}
+
+CGlyphRenderer::~CGlyphRenderer() {
+#ifndef GLES2
+    if (!m_program)
+        return;
+
+    g_pHyprRenderer->makeEGLCurrent();
+
+    glDeleteTextures(1, &m_texture);
+    glDeleteBuffers(1, &m_instanceVbo);
+    glDeleteBuffers(1, &m_cornerVbo);
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteProgram(m_program);
+#endif
+}
+
+bool CGlyphRenderer::ok() const {
+    return m_program != 0;
+}
+
+BarRaster::CGlyphAtlas& CGlyphRenderer::atlas() {
+    return m_atlas;
+}
+
+size_t CGlyphRenderer::bytes() const {
+    return m_program ? m_atlas.bytes() : 0;
+}
+
+void CGlyphRenderer::upload() {
+#ifndef GLES2
+    // only the rows glyphs were added to since the last draw, the whole page after it started over
+    const auto [FIRST, LAST] = m_atlas.takeDirtyRows();
+
+    if (LAST <= FIRST)
+        return;
+
+    const int SIZE = m_atlas.size();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, FIRST, SIZE, LAST - FIRST, GL_RED, GL_UNSIGNED_BYTE, m_atlas.pixels() + (size_t)FIRST * SIZE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+#endif
+}
+
+void CGlyphRenderer::draw(const std::vector<BarRaster::SGlyphQuad>& quads, const Vector2D& origin, float scale, const CHyprColor& color, const CBox& clip) {
+#ifndef GLES2
+    if (!m_program || quads.empty() || clip.w < 1 || clip.h < 1)
+        return;
+
+    CRegion damage{g_pHyprOpenGL->m_renderData.damage};
+    damage.intersect(clip);
+
+    if (damage.empty())
+        return;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    upload();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+    if (quads.size() > m_instanceCap) {
+        m_instanceCap = std::max(quads.size(), m_instanceCap * 2);
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCap * sizeof(BarRaster::SGlyphQuad), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, quads.size() * sizeof(BarRaster::SGlyphQuad), quads.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const auto MATRIX   = g_pHyprOpenGL->m_renderData.monitorProjection.projectBox(clip, HYPRUTILS_TRANSFORM_NORMAL, clip.rot);
+    const auto GLMATRIX = g_pHyprOpenGL->m_renderData.projection.copy().multiply(MATRIX).getMatrix();
+
+    g_pHyprOpenGL->useProgram(m_program);
+    glUniformMatrix3fv(m_loc.proj, 1, GL_TRUE, GLMATRIX.data());
+    glUniform4f(m_loc.box, clip.x, clip.y, clip.w, clip.h);
+    glUniform3f(m_loc.place, origin.x, origin.y, scale);
+    // premultiplied, like everything else Hyprland blends
+    glUniform4f(m_loc.color, color.r * color.a, color.g * color.a, color.b * color.a, color.a);
+    glUniform1i(m_loc.atlas, 0);
+
+    g_pHyprOpenGL->blend(true);
+
+    glBindVertexArray(m_vao);
+
+    for (const auto& RECT : damage.getRects()) {
+        g_pHyprOpenGL->scissor(&RECT);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, quads.size());
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+#endif
+}
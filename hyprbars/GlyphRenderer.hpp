@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+
+#include "GlyphAtlas.hpp"
+
+// Draws titles straight from the glyph atlas for text_engine = atlas: one instanced quad per glyph,
+// the distance field turned into coverage in the fragment shader. Titles then cost a few floats each
+// instead of a texture, and changing one doesn't rasterize or upload anything past new glyphs.
+// Created with the GL context current, on the first title drawn this way.
+class CGlyphRenderer {
+  public:
+    CGlyphRenderer();
+    ~CGlyphRenderer();
+
+    CGlyphRenderer(const CGlyphRenderer&)            = delete;
+    CGlyphRenderer& operator=(const CGlyphRenderer&) = delete;
+
+    // false if the shader didn't compile or this is a GLES2 build, titles go through Pango then
+    bool                    ok() const;
+
+    BarRaster::CGlyphAtlas& atlas();
+
+    // draws the quads of a title with the layout origin at origin, scaled by scale. Framebuffer pixels,
+    // nothing outside of clip is touched.
+    void draw(const std::vector<BarRaster::SGlyphQuad>& quads, const Vector2D& origin, float scale, const CHyprColor& color, const CBox& clip);
+
+    // the atlas texture
+    size_t bytes() const;
+
+  private:
+    void                   upload();
+
+    BarRaster::CGlyphAtlas m_atlas;
+
+    GLuint                 m_program     = 0;
+    GLuint                 m_vao         = 0;
+    GLuint                 m_cornerVbo   = 0;
+    GLuint                 m_instanceVbo = 0;
+    GLuint                 m_texture     = 0;
+    size_t                 m_instanceCap = 0; // glyphs the instance buffer has room for
+
+    struct {
+        GLint proj   = -1;
+        GLint box    = -1;
+        GLint place  = -1;
+        GLint color  = -1;
+        GLint atlas  = -1;
+        GLint corner = -1;
+        GLint rect   = -1;
+        GLint uv     = -1;
+    } m_loc;
+};
+
+inline UP<CGlyphRenderer> g_pGlyphRenderer;
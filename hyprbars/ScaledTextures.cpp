@@ -0,0 +1,41 @@
+#include "ScaledTextures.hpp"
+
+#include <algorithm>
+
+#include "TextureResidency.hpp"
+
+SP<CTexture> CScaledTextures::get(float scale) {
+    auto it = std::ranges::find(m_variants, scale, &SVariant::scale);
+
+    if (it == m_variants.end())
+        it = m_variants.insert(m_variants.end(), SVariant{.scale = scale, .tex = makeShared<CTexture>()});
+
+    it->lastUse = Time::steadyNow();
+
+    return it->tex;
+}
+
+size_t CScaledTextures::dropUnusedSince(const Time::steady_tp& since) {
+    size_t freed = 0;
+
+    std::erase_if(m_variants, [&](const SVariant& v) {
+        if (v.lastUse >= since)
+            return false;
+
+        freed += CTextureResidency::textureBytes(v.tex);
+        v.tex->destroyTexture();
+        return true;
+    });
+
+    return freed;
+}
+
+void CScaledTextures::destroy() {
+    for (auto& v : m_variants) {
+        v.tex->destroyTexture();
+    }
+}
+
+const std::vector<CScaledTextures::SVariant>& CScaledTextures::variants() const {
+    return m_variants;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/render/Texture.hpp>
+
+// One texture per monitor scale it's drawn at, so something on a window spanning monitors of
+// different scales is crisp on all of them. Used for the button icons, which are rasterized once
+// and shared by every bar showing the button.
+class CScaledTextures {
+  public:
+    struct SVariant {
+        float           scale = 0;
+        SP<CTexture>    tex;
+        Time::steady_tp lastUse;
+    };
+
+    // the texture for the scale, empty (m_texID 0) until something is rasterized into it
+    SP<CTexture>                 get(float scale);
+
+    // drops the variants that weren't used since the given point, returns the bytes freed
+    size_t                       dropUnusedSince(const Time::steady_tp& since);
+    void                         destroy();
+
+    const std::vector<SVariant>& variants() const;
+
+  private:
+    std::vector<SVariant> m_variants;
+};
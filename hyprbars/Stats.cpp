@@ -0,0 +1,224 @@
+#include "Stats.hpp"
+
+#include <hyprland/src/Compositor.hpp>
+#include <hyprland/src/helpers/Monitor.hpp>
+#include <hyprland/src/render/OpenGL.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+#include <pango/pangocairo.h>
+
+#include <format>
+
+#include "globals.hpp"
+
+constexpr std::array<const char*, BAR_STAT_SECTION_COUNT> SECTIONNAMES = {"rect", "title_raster", "gl_upload", "buttons", "icons", "other"};
+
+static const Vector2D                                     OVERLAYSIZE = {300, 130};
+
+static CScopedBarStat*                                    currentScope = nullptr;
+
+CBarStats::CBarStats() {
+    m_pEnabled    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:stats")->getDataStaticPtr();
+    m_pOverlayTex = makeShared<CTexture>();
+}
+
+bool CBarStats::enabled() {
+    return **m_pEnabled > 0;
+}
+
+void CBarStats::addSectionTime(eBarStatSection section, std::chrono::steady_clock::duration d) {
+    const auto NS = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    m_window.sectionNs[section] += NS;
+    m_total.sectionNs[section] += NS;
+}
+
+void CBarStats::onFrame() {
+    if (!enabled())
+        return;
+
+    m_window.frames++;
+    m_total.frames++;
+
+    if (std::chrono::steady_clock::now() - m_windowStart >= std::chrono::seconds(1))
+        rollWindow();
+}
+
+void CBarStats::onRenderPass() {
+    if (!enabled())
+        return;
+
+    m_window.renderPasses++;
+    m_total.renderPasses++;
+}
+
+void CBarStats::onTitleRender() {
+    if (!enabled())
+        return;
+
+    m_window.titleRenders++;
+    m_total.titleRenders++;
+}
+
+void CBarStats::onUpload(size_t bytes) {
+    if (!enabled())
+        return;
+
+    m_window.uploadedBytes += bytes;
+    m_total.uploadedBytes += bytes;
+}
+
+void CBarStats::onHoverDamage() {
+    if (!enabled())
+        return;
+
+    m_window.hoverDamages++;
+    m_total.hoverDamages++;
+}
+
+void CBarStats::onOccluded() {
+    if (!enabled())
+        return;
+
+    m_window.occluded++;
+    m_total.occluded++;
+}
+
+void CBarStats::reset() {
+    m_total       = {};
+    m_window      = {};
+    m_lastSecond  = {};
+    m_windowStart = std::chrono::steady_clock::now();
+}
+
+void CBarStats::rollWindow() {
+    m_lastSecond  = m_window;
+    m_window      = {};
+    m_windowStart = std::chrono::steady_clock::now();
+
+    if (**m_pEnabled < 2)
+        return;
+
+    m_bOverlayDirty = true;
+
+    for (const auto& m : g_pCompositor->m_monitors) {
+        g_pHyprRenderer->damageBox(CBox{m->m_position, OVERLAYSIZE});
+    }
+}
+
+static std::string describeCounters(const SBarStatCounters& c, bool json) {
+    const double FRAMES   = std::max<uint64_t>(c.frames, 1);
+    uint64_t     totalNs  = 0;
+    std::string  sections = "";
+
+    for (size_t i = 0; i < BAR_STAT_SECTION_COUNT; ++i) {
+        totalNs += c.sectionNs[i];
+
+        if (json)
+            sections += std::format(R"({}"{}": {:.2f})", i ? ", " : "", SECTIONNAMES[i], c.sectionNs[i] / 1000.0 / FRAMES);
+        else
+            sections += std::format("    {}: {:.2f}us\n", SECTIONNAMES[i], c.sectionNs[i] / 1000.0 / FRAMES);
+    }
+
+    if (json)
+        return std::format(R"({{"frames": {}, "render_passes": {}, "render_pass_us_per_frame": {:.2f}, "sections_us_per_frame": {{{}}}, "title_renders": {}, "uploaded_bytes": {}, "hover_damages": {}, "occluded": {}}})",
+                           c.frames, c.renderPasses, totalNs / 1000.0 / FRAMES, sections, c.titleRenders, c.uploadedBytes, c.hoverDamages, c.occluded);
+
+    return std::format("  frames: {}\n  render passes: {}\n  renderPass per frame: {:.2f}us\n{}  title renders: {}\n  uploaded bytes: {}\n  hover damages: {}\n  occluded: {}\n",
+                       c.frames, c.renderPasses, totalNs / 1000.0 / FRAMES, sections, c.titleRenders, c.uploadedBytes, c.hoverDamages, c.occluded);
+}
+
+std::string CBarStats::describe(bool json) {
+    if (json)
+        return std::format(R"({{"enabled": {}, "last_second": {}, "total": {}}})", enabled(), describeCounters(m_lastSecond, true), describeCounters(m_total, true));
+
+    return std::format("enabled: {}\nlast second:\n{}total:\n{}", enabled(), describeCounters(m_lastSecond, false), describeCounters(m_total, false));
+}
+
+const SP<CTexture>& CBarStats::overlayTexture() {
+    return m_pOverlayTex;
+}
+
+void CBarStats::renderOverlayTexture() {
+    const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, OVERLAYSIZE.x, OVERLAYSIZE.y);
+    const auto CAIRO        = cairo_create(CAIROSURFACE);
+
+    cairo_set_source_rgba(CAIRO, 0, 0, 0, 0.7);
+    cairo_paint(CAIRO);
+
+    const auto& C      = m_lastSecond;
+    const auto  FRAMES = (double)std::max<uint64_t>(C.frames, 1);
+
+    std::string text = std::format("hyprbars, last second\nframes: {}  bar passes: {}  occluded: {}\n", C.frames, C.renderPasses, C.occluded);
+    for (size_t i = 0; i < BAR_STAT_SECTION_COUNT; ++i) {
+        text += std::format("{}: {:.1f}us/frame\n", SECTIONNAMES[i], C.sectionNs[i] / 1000.0 / FRAMES);
+    }
+    text += std::format("titles: {}/s  upload: {}KiB/s  hover damage: {}/s", C.titleRenders, C.uploadedBytes / 1024, C.hoverDamages);
+
+    PangoLayout*          layout   = pango_cairo_create_layout(CAIRO);
+    PangoFontDescription* fontDesc = pango_font_description_from_string("monospace 8");
+    pango_layout_set_font_description(layout, fontDesc);
+    pango_font_description_free(fontDesc);
+    pango_layout_set_text(layout, text.c_str(), -1);
+
+    cairo_set_source_rgba(CAIRO, 1, 1, 1, 1);
+    cairo_move_to(CAIRO, 6, 4);
+    pango_cairo_show_layout(CAIRO, layout);
+    g_object_unref(layout);
+
+    cairo_surface_flush(CAIROSURFACE);
+
+    m_pOverlayTex->allocate();
+    m_pOverlayTex->m_size = OVERLAYSIZE;
+    glBindTexture(GL_TEXTURE_2D, m_pOverlayTex->m_texID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+#ifndef GLES2
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+#endif
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, OVERLAYSIZE.x, OVERLAYSIZE.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, cairo_image_surface_get_data(CAIROSURFACE));
+
+    cairo_destroy(CAIRO);
+    cairo_surface_destroy(CAIROSURFACE);
+
+    m_bOverlayDirty = false;
+}
+
+void CBarStats::renderOverlay() {
+    if (**m_pEnabled < 2)
+        return;
+
+    const auto PMONITOR = g_pHyprOpenGL->m_renderData.pMonitor.lock();
+    if (!PMONITOR)
+        return;
+
+    if (m_bOverlayDirty || m_pOverlayTex->m_texID == 0)
+        renderOverlayTexture();
+
+    CBox box = {{0, 0}, OVERLAYSIZE};
+    box.scale(PMONITOR->m_scale).round();
+    g_pHyprOpenGL->renderTexture(m_pOverlayTex, box, {});
+}
+
+CScopedBarStat::CScopedBarStat(eBarStatSection section) : m_section(section) {
+    if (!g_pBarStats->enabled())
+        return;
+
+    m_active     = true;
+    m_pParent    = currentScope;
+    currentScope = this;
+    m_begin      = std::chrono::steady_clock::now();
+}
+
+CScopedBarStat::~CScopedBarStat() {
+    if (!m_active)
+        return;
+
+    const auto ELAPSED = std::chrono::steady_clock::now() - m_begin;
+
+    g_pBarStats->addSectionTime(m_section, ELAPSED - m_childTime);
+
+    if (m_pParent)
+        m_pParent->m_childTime += ELAPSED;
+
+    currentScope = m_pParent;
+}
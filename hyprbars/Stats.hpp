@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/render/Texture.hpp>
+
+enum eBarStatSection : uint8_t {
+    BAR_STAT_RECT = 0,
+    BAR_STAT_TITLE_RASTER,
+    BAR_STAT_UPLOAD,
+    BAR_STAT_BUTTONS,
+    BAR_STAT_ICONS,
+    BAR_STAT_OTHER, // rest of renderPass not covered by a section
+    BAR_STAT_SECTION_COUNT,
+};
+
+struct SBarStatCounters {
+    std::array<uint64_t, BAR_STAT_SECTION_COUNT> sectionNs     = {};
+    uint64_t                                     renderPasses  = 0;
+    uint64_t                                     frames        = 0;
+    uint64_t                                     titleRenders  = 0;
+    uint64_t                                     uploadedBytes = 0;
+    uint64_t                                     hoverDamages  = 0;
+    uint64_t                                     occluded      = 0; // draws skipped, the bar was covered
+};
+
+// Opt-in frame time accounting, plugin:hyprbars:stats. 0 = off, 1 = collect, 2 = collect + overlay.
+// When off, nothing reads a clock and no counter is touched.
+class CBarStats {
+  public:
+    CBarStats();
+
+    bool        enabled();
+
+    void        addSectionTime(eBarStatSection section, std::chrono::steady_clock::duration d);
+    void        onFrame();
+    void        onRenderPass();
+    void        onTitleRender();
+    void        onUpload(size_t bytes);
+    void        onHoverDamage();
+    void        onOccluded();
+
+    void        reset();
+    std::string describe(bool json);
+
+    // draws the overlay on the monitor being rendered, if enabled
+    void                renderOverlay();
+    const SP<CTexture>& overlayTexture();
+
+  private:
+    Hyprlang::INT* const*                 m_pEnabled = nullptr;
+
+    SBarStatCounters                      m_total;
+    SBarStatCounters                      m_window;
+    SBarStatCounters                      m_lastSecond;
+    std::chrono::steady_clock::time_point m_windowStart = std::chrono::steady_clock::now();
+
+    SP<CTexture>                          m_pOverlayTex;
+    bool                                  m_bOverlayDirty = true;
+
+    void                                  rollWindow();
+    void                                  renderOverlayTexture();
+};
+
+inline UP<CBarStats> g_pBarStats;
+
+// times the enclosing scope into a section. Nested scopes are exclusive: the time of an inner
+// scope is not counted again in the outer one.
+class CScopedBarStat {
+  public:
+    CScopedBarStat(eBarStatSection section);
+    ~CScopedBarStat();
+
+  private:
+    eBarStatSection                       m_section;
+    bool                                  m_active = false;
+    std::chrono::steady_clock::time_point m_begin;
+    std::chrono::steady_clock::duration   m_childTime = {};
+    CScopedBarStat*                       m_pParent   = nullptr;
+};
@@ -0,0 +1,120 @@
+#include "Swizzle.hpp"
+
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SWIZZLE_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SWIZZLE_NEON
+#endif
+
+static inline void swizzleRow(const uint8_t* src, uint8_t* dst, size_t width) {
+    for (size_t x = 0; x < width; ++x) {
+        uint32_t px;
+        std::memcpy(&px, src + x * 4, 4);
+
+        // cairo pixels are native endian 0xAARRGGBB
+        dst[x * 4 + 0] = (px >> 16) & 0xFF;
+        dst[x * 4 + 1] = (px >> 8) & 0xFF;
+        dst[x * 4 + 2] = px & 0xFF;
+        dst[x * 4 + 3] = px >> 24;
+    }
+}
+
+void Swizzle::bgraToRgbaScalar(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height) {
+    for (size_t y = 0; y < height; ++y) {
+        swizzleRow(src + y * srcStride, dst + y * dstStride, width);
+    }
+}
+
+#ifdef SWIZZLE_X86
+// SSE2 has no byte shuffle, so swap R and B with masks and shifts: keep A and G in place,
+// and rotate the 16 bit halves of what's left
+static void bgraToRgbaSSE2(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height) {
+    const __m128i AG = _mm_set1_epi32(0xFF00FF00);
+    const __m128i RB = _mm_set1_epi32(0x00FF00FF);
+
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* s = src + y * srcStride;
+        uint8_t*       d = dst + y * dstStride;
+        size_t         x = 0;
+
+        for (; x + 4 <= width; x += 4) {
+            const __m128i PX  = _mm_loadu_si128((const __m128i*)(s + x * 4));
+            const __m128i OUT = _mm_or_si128(_mm_and_si128(PX, AG), _mm_and_si128(_mm_or_si128(_mm_slli_epi32(PX, 16), _mm_srli_epi32(PX, 16)), RB));
+            _mm_storeu_si128((__m128i*)(d + x * 4), OUT);
+        }
+
+        swizzleRow(s + x * 4, d + x * 4, width - x);
+    }
+}
+
+__attribute__((target("avx2"))) static void bgraToRgbaAVX2(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height) {
+    const __m256i SHUFFLE = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* s = src + y * srcStride;
+        uint8_t*       d = dst + y * dstStride;
+        size_t         x = 0;
+
+        for (; x + 8 <= width; x += 8) {
+            const __m256i PX = _mm256_loadu_si256((const __m256i*)(s + x * 4));
+            _mm256_storeu_si256((__m256i*)(d + x * 4), _mm256_shuffle_epi8(PX, SHUFFLE));
+        }
+
+        swizzleRow(s + x * 4, d + x * 4, width - x);
+    }
+}
+#endif
+
+#ifdef SWIZZLE_NEON
+static void bgraToRgbaNEON(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height) {
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* s = src + y * srcStride;
+        uint8_t*       d = dst + y * dstStride;
+        size_t         x = 0;
+
+        for (; x + 16 <= width; x += 16) {
+            uint8x16x4_t px = vld4q_u8(s + x * 4);
+            std::swap(px.val[0], px.val[2]);
+            vst4q_u8(d + x * 4, px);
+        }
+
+        swizzleRow(s + x * 4, d + x * 4, width - x);
+    }
+}
+#endif
+
+std::vector<Swizzle::SKernel> Swizzle::kernels() {
+    std::vector<SKernel> out;
+
+#ifdef SWIZZLE_X86
+    // we may run before the constructor that fills in the cpu model
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+        out.push_back({bgraToRgbaAVX2, "avx2"});
+#if defined(__SSE2__)
+    out.push_back({bgraToRgbaSSE2, "sse2"});
+#endif
+#endif
+#ifdef SWIZZLE_NEON
+    out.push_back({bgraToRgbaNEON, "neon"});
+#endif
+    out.push_back({Swizzle::bgraToRgbaScalar, "scalar"});
+
+    return out;
+}
+
+static const Swizzle::SKernel KERNEL = Swizzle::kernels().front();
+
+void Swizzle::bgraToRgba(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height) {
+    KERNEL.fn(src, srcStride, dst, dstStride, width, height);
+}
+
+const char* Swizzle::kernelName() {
+    return KERNEL.name;
+}
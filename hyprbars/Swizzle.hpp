@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Converts cairo's ARGB32 pixels (BGRA in memory on little endian) to the RGBA byte order GL takes,
+// for uploads that can't use GL_TEXTURE_SWIZZLE. Cairo's pixels are premultiplied already, which is
+// what we render with, so there's nothing to multiply, only bytes to move.
+// Like BarRaster, nothing here depends on Hyprland.
+namespace Swizzle {
+    // src and dst may be the same buffer. Strides are in bytes.
+    void        bgraToRgba(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height);
+
+    // reference implementation, also used for the row tails
+    void        bgraToRgbaScalar(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t width, size_t height);
+
+    // the kernel bgraToRgba uses on this cpu: "avx2", "sse2", "neon" or "scalar"
+    const char* kernelName();
+
+    using PSWIZZLEFN = void (*)(const uint8_t*, size_t, uint8_t*, size_t, size_t, size_t);
+
+    struct SKernel {
+        PSWIZZLEFN  fn;
+        const char* name;
+    };
+
+    // every kernel this cpu can run, the one bgraToRgba uses first and the scalar one last.
+    // For checking them against each other, see bench/swizzle.cpp.
+    std::vector<SKernel> kernels();
+}
@@ -0,0 +1,269 @@
+#include "TextureResidency.hpp"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <unordered_set>
+
+#include "barDeco.hpp"
+#include "globals.hpp"
+#include "GlyphRenderer.hpp"
+#include "Stats.hpp"
+
+// how often the budget is checked, how long a bar has to go undrawn before it can be evicted,
+// and how long to wait for the bars to re-render before changing the degradation level again
+constexpr std::chrono::milliseconds CHECK_INTERVAL{500};
+constexpr std::chrono::seconds      COLD_AFTER{2};
+constexpr std::chrono::seconds      LEVEL_SETTLE{3};
+
+constexpr std::array<const char*, 3> LEVELNAMES = {"none", "share_titles", "half_res"};
+
+size_t STextureUsage::total() const {
+    return titles + buttons + icons + ruleIcons + overlay + glyphAtlas;
+}
+
+CTextureResidency::CTextureResidency() {
+    m_pBudget = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:texture_budget_mb")->getDataStaticPtr();
+}
+
+size_t CTextureResidency::textureBytes(const SP<CTexture>& tex) {
+    if (!tex || tex->m_texID == 0)
+        return 0;
+
+    return (size_t)tex->m_size.x * (size_t)tex->m_size.y * 4;
+}
+
+size_t CTextureResidency::dropTexture(SP<CTexture>& tex) {
+    // a shared title is just let go of, other bars may still be showing it
+    if (tex.strongRef() > 1) {
+        tex = makeShared<CTexture>();
+        return 0;
+    }
+
+    const auto BYTES = textureBytes(tex);
+    tex->destroyTexture();
+    return BYTES;
+}
+
+void CTextureResidency::account() {
+    // shared titles and interned button sets are counted once
+    std::unordered_set<CTexture*> seen;
+    const auto                    COUNT = [&seen](const SP<CTexture>& tex) -> size_t { return seen.emplace(tex.get()).second ? textureBytes(tex) : 0; };
+
+    m_usage        = {};
+    m_residentBars = 0;
+
+    for (auto& b : g_pGlobalState->bars) {
+        const auto PBAR = b.get();
+
+        if (!PBAR)
+            continue;
+
+        auto title   = COUNT(PBAR->m_pTextTex);
+        auto buttons = COUNT(PBAR->m_pButtonsTex);
+
+        for (auto& v : PBAR->m_otherScales) {
+            title += COUNT(v.textTex);
+            buttons += COUNT(v.buttonsTex);
+        }
+
+        m_usage.titles += title;
+        m_usage.buttons += buttons;
+
+        if (title + buttons > 0)
+            m_residentBars++;
+    }
+
+    for (auto& button : g_pGlobalState->buttons) {
+        for (auto& v : button.iconTextures->variants()) {
+            m_usage.icons += COUNT(v.tex);
+        }
+    }
+
+    std::erase_if(m_sharedTitles, [](const auto& e) { return e.second.expired(); });
+
+    for (auto& [key, set] : g_pGlobalState->buttonSets) {
+        const auto PSET = set.lock();
+
+        if (!PSET)
+            continue;
+
+        for (auto& button : PSET->buttons) {
+            for (auto& v : button.iconTextures->variants()) {
+                m_usage.ruleIcons += COUNT(v.tex);
+            }
+        }
+    }
+
+    m_usage.overlay    = COUNT(g_pBarStats->overlayTexture());
+    m_usage.glyphAtlas = g_pGlyphRenderer ? g_pGlyphRenderer->bytes() : 0;
+}
+
+void CTextureResidency::onFrame() {
+    const auto NOW = Time::steadyNow();
+
+    if (NOW - m_lastCheck < CHECK_INTERVAL)
+        return;
+
+    m_lastCheck = NOW;
+
+    account();
+
+    const size_t BUDGET = (size_t)std::max<Hyprlang::INT>(**m_pBudget, 0) * 1024 * 1024;
+
+    if (BUDGET == 0) {
+        setDegradation(TEXTURE_DEGRADATION_NONE);
+        return;
+    }
+
+    if (m_usage.total() > BUDGET) {
+        evict(BUDGET);
+        account();
+    }
+
+    if (NOW - m_lastLevelChange < LEVEL_SETTLE)
+        return;
+
+    if (m_usage.total() > BUDGET && m_level < TEXTURE_DEGRADATION_HALF_RES)
+        setDegradation((eTextureDegradation)(m_level + 1));
+    else if (m_level > TEXTURE_DEGRADATION_NONE) {
+        // rough guess of what going back up a level costs: half res textures are a quarter of the size,
+        // shared titles are assumed to be shared by two bars on average.
+        const auto RESTORED = m_level == TEXTURE_DEGRADATION_HALF_RES ? m_usage.total() + (m_usage.titles + m_usage.buttons) * 3 : m_usage.total() + m_usage.titles;
+
+        if (RESTORED < BUDGET)
+            setDegradation((eTextureDegradation)(m_level - 1));
+    }
+}
+
+void CTextureResidency::evict(size_t budget) {
+    const auto NOW   = Time::steadyNow();
+    size_t     total = m_usage.total();
+
+    // rasters for monitor scales a bar or icon isn't drawn at anymore go first, they cost a re-raster
+    // only if the window goes back to that monitor
+    for (auto& b : g_pGlobalState->bars) {
+        const auto PBAR = b.get();
+
+        if (!PBAR)
+            continue;
+
+        std::erase_if(PBAR->m_otherScales, [&](auto& v) {
+            if (NOW - v.lastDrawn < COLD_AFTER)
+                return false;
+
+            total -= dropTexture(v.textTex) + dropTexture(v.buttonsTex);
+            return true;
+        });
+    }
+
+    const auto DROPICONS = [&](const std::vector<SHyprButton>& buttons) {
+        for (auto& button : buttons) {
+            total -= button.iconTextures->dropUnusedSince(NOW - COLD_AFTER);
+        }
+    };
+
+    DROPICONS(g_pGlobalState->buttons);
+    for (auto& [key, set] : g_pGlobalState->buttonSets) {
+        if (const auto PSET = set.lock(); PSET)
+            DROPICONS(PSET->buttons);
+    }
+
+    std::vector<CHyprBar*> cold;
+    for (auto& b : g_pGlobalState->bars) {
+        const auto PBAR = b.get();
+
+        if (!PBAR || NOW - PBAR->m_lastDrawn < COLD_AFTER)
+            continue;
+
+        if (textureBytes(PBAR->m_pTextTex) + textureBytes(PBAR->m_pButtonsTex) > 0)
+            cold.emplace_back(PBAR);
+    }
+
+    std::ranges::sort(cold, {}, [](CHyprBar* bar) { return bar->m_lastDrawn; });
+
+    size_t evicted = 0;
+    for (const auto PBAR : cold) {
+        if (total <= budget)
+            break;
+
+        // the title and buttons are re-rasterized on the next draw since their texture ids are 0
+        total -= dropTexture(PBAR->m_pTextTex) + dropTexture(PBAR->m_pButtonsTex);
+
+        evicted++;
+    }
+
+    m_evictions += evicted;
+
+    if (evicted > 0)
+        Debug::log(LOG, "[hyprbars] evicted the textures of {} cold bars, {} KiB in use", evicted, total / 1024);
+}
+
+void CTextureResidency::setDegradation(eTextureDegradation level) {
+    if (level == m_level)
+        return;
+
+    Debug::log(LOG, "[hyprbars] texture degradation {} -> {}", LEVELNAMES[m_level], LEVELNAMES[level]);
+
+    m_level           = level;
+    m_lastLevelChange = Time::steadyNow();
+
+    if (m_level < TEXTURE_DEGRADATION_SHARE_TITLES)
+        m_sharedTitles.clear();
+
+    for (auto& b : g_pGlobalState->bars) {
+        if (const auto PBAR = b.get(); PBAR) {
+            PBAR->m_bTitleDirty   = true;
+            PBAR->m_bButtonsDirty = true;
+            PBAR->damageEntire();
+        }
+    }
+}
+
+eTextureDegradation CTextureResidency::degradation() {
+    return m_level;
+}
+
+float CTextureResidency::rasterScale() {
+    return m_level >= TEXTURE_DEGRADATION_HALF_RES ? 0.5F : 1.F;
+}
+
+SP<CTexture> CTextureResidency::sharedTitle(const std::string& key) {
+    const auto IT = m_sharedTitles.find(key);
+
+    if (IT == m_sharedTitles.end())
+        return nullptr;
+
+    const auto TEX = IT->second.lock();
+    return TEX && TEX->m_texID != 0 ? TEX : nullptr;
+}
+
+void CTextureResidency::shareTitle(const std::string& key, SP<CTexture> tex) {
+    m_sharedTitles[key] = tex;
+}
+
+const STextureUsage& CTextureResidency::usage() {
+    return m_usage;
+}
+
+std::string CTextureResidency::describe(bool json) {
+    account();
+
+    const auto BUDGET = std::max<Hyprlang::INT>(**m_pBudget, 0);
+    const auto U      = m_usage;
+
+    // not textures, but the other memory rasterizing keeps around
+    const auto& POOL = g_pGlobalState->rasterSurfaces;
+
+    if (json)
+        return std::format(
+            R"({{"budget_mb": {}, "total_bytes": {}, "titles_bytes": {}, "buttons_bytes": {}, "icons_bytes": {}, "rule_icons_bytes": {}, "overlay_bytes": {}, "glyph_atlas_bytes": {}, "bars": {}, "resident_bars": {}, "evictions": {}, "degradation": "{}", "shared_titles": {}, "raster_surfaces": {}, "raster_surfaces_bytes": {}}})",
+            BUDGET, U.total(), U.titles, U.buttons, U.icons, U.ruleIcons, U.overlay, U.glyphAtlas, g_pGlobalState->bars.size(), m_residentBars, m_evictions, LEVELNAMES[m_level],
+            m_sharedTitles.size(), POOL.size(), POOL.bytes());
+
+    return std::format("budget: {}\ntotal: {} KiB\n  titles: {} KiB\n  buttons: {} KiB\n  icons: {} KiB\n  rule icons: {} KiB\n  overlay: {} KiB\n  glyph atlas: {} KiB\n"
+                       "bars: {} ({} resident)\nevictions: {}\ndegradation: {}\nshared titles: {}\nraster surfaces: {} ({} KiB)\n",
+                       BUDGET ? std::format("{} MiB", BUDGET) : "off", U.total() / 1024, U.titles / 1024, U.buttons / 1024, U.icons / 1024, U.ruleIcons / 1024,
+                       U.overlay / 1024, U.glyphAtlas / 1024, g_pGlobalState->bars.size(), m_residentBars, m_evictions, LEVELNAMES[m_level], m_sharedTitles.size(), POOL.size(),
+                       POOL.bytes() / 1024);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/plugins/PluginAPI.hpp>
+#include <hyprland/src/render/Texture.hpp>
+
+// what we give up, in order, when the textures don't fit in the budget even after evicting cold bars
+enum eTextureDegradation : uint8_t {
+    TEXTURE_DEGRADATION_NONE = 0,
+    TEXTURE_DEGRADATION_SHARE_TITLES, // bars with identical titles share one texture
+    TEXTURE_DEGRADATION_HALF_RES,     // titles and buttons are rasterized at half resolution
+};
+
+struct STextureUsage {
+    size_t titles     = 0;
+    size_t buttons    = 0;
+    size_t icons      = 0; // icons of the hyprbars-button buttons
+    size_t ruleIcons  = 0; // icons of the buttons added by window rules
+    size_t overlay    = 0;
+    size_t glyphAtlas = 0; // text_engine = atlas, shared by every title
+
+    size_t total() const;
+};
+
+// Accounts for every texture hyprbars owns and keeps them under plugin:hyprbars:texture_budget_mb.
+// When over budget, bars that haven't been drawn for a while lose their title and button textures,
+// least recently drawn first, and get them re-rasterized through the usual dirty checks once they're
+// drawn again. If that's not enough, the textures are degraded, see eTextureDegradation.
+// A budget of 0 turns all of this off.
+class CTextureResidency {
+  public:
+    CTextureResidency();
+
+    // called at the start of every frame, with the GL context current
+    void                 onFrame();
+
+    eTextureDegradation  degradation();
+    // scale to rasterize titles and buttons at, relative to the monitor scale
+    float                rasterScale();
+
+    // identical titles, only used from TEXTURE_DEGRADATION_SHARE_TITLES on
+    SP<CTexture>         sharedTitle(const std::string& key);
+    void                 shareTitle(const std::string& key, SP<CTexture> tex);
+
+    const STextureUsage& usage();
+    std::string          describe(bool json);
+
+    static size_t        textureBytes(const SP<CTexture>& tex);
+
+  private:
+    void                                          account();
+    void                                          evict(size_t budget);
+    void                                          setDegradation(eTextureDegradation level);
+
+    // destroys the texture, or lets go of it if it's shared. Returns the bytes freed
+    static size_t                                 dropTexture(SP<CTexture>& tex);
+
+    Hyprlang::INT* const*                         m_pBudget         = nullptr;
+    Time::steady_tp                               m_lastCheck       = Time::steadyNow();
+    Time::steady_tp                               m_lastLevelChange = Time::steadyNow();
+    STextureUsage                                 m_usage;
+    size_t                                        m_residentBars    = 0;
+    size_t                                        m_evictions       = 0;
+    eTextureDegradation                           m_level           = TEXTURE_DEGRADATION_NONE;
+    std::unordered_map<std::string, WP<CTexture>> m_sharedTitles;
+};
+
+inline UP<CTextureResidency> g_pTextureResidency;
@@ -9,33 +9,28 @@
 #include <hyprland/src/managers/LayoutManager.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/managers/animation/AnimationManager.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopManager.hpp>
 #include <hyprland/src/protocols/LayerShell.hpp>
 #include <pango/pangocairo.h>
+#include <algorithm>
 
 #include "globals.hpp"
 #include "BarPassElement.hpp"
+#include "BarInput.hpp"
+#include "BarLayout.hpp"
+#include "BarRaster.hpp"
+#include "GlyphRenderer.hpp"
+#include "Stats.hpp"
+#include "Swizzle.hpp"
+#include "TextureResidency.hpp"
+#include "../common/Trace.hpp"
 
 CHyprBar::CHyprBar(PHLWINDOW pWindow) : IHyprWindowDecoration(pWindow) {
     m_pWindow = pWindow;
 
     static auto* const PCOLOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_color")->getDataStaticPtr();
 
-    const auto         PMONITOR = pWindow->m_monitor.lock();
-    PMONITOR->m_scheduledRecalc = true;
-
-    //button events
-    m_pMouseButtonCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "mouseButton", [&](void* self, SCallbackInfo& info, std::any param) { onMouseButton(info, std::any_cast<IPointer::SButtonEvent>(param)); });
-    m_pTouchDownCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "touchDown", [&](void* self, SCallbackInfo& info, std::any param) { onTouchDown(info, std::any_cast<ITouch::SDownEvent>(param)); });
-    m_pTouchUpCallback = HyprlandAPI::registerCallbackDynamic( //
-        PHANDLE, "touchUp", [&](void* self, SCallbackInfo& info, std::any param) { onTouchUp(info, std::any_cast<ITouch::SUpEvent>(param)); });
-
-    //move events
-    m_pTouchMoveCallback = HyprlandAPI::registerCallbackDynamic(
-        PHANDLE, "touchMove", [&](void* self, SCallbackInfo& info, std::any param) { onTouchMove(info, std::any_cast<ITouch::SMotionEvent>(param)); });
-    m_pMouseMoveCallback = HyprlandAPI::registerCallbackDynamic( //
-        PHANDLE, "mouseMove", [&](void* self, SCallbackInfo& info, std::any param) { onMouseMove(std::any_cast<Vector2D>(param)); });
+    m_bWindowHasFocus = pWindow == g_pCompositor->m_lastWindow.lock();
 
     m_pTextTex    = makeShared<CTexture>();
     m_pButtonsTex = makeShared<CTexture>();
@@ -44,12 +39,52 @@ CHyprBar::CHyprBar(PHLWINDOW pWindow) : IHyprWindowDecoration(pWindow) {
     m_cRealBarColor->setUpdateCallback([&](auto) { damageEntire(); });
 }
 
+void CHyprBar::setFocused(bool focused) {
+    static auto* const PINACTIVECOLOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:inactive_button_color")->getDataStaticPtr();
+
+    if (focused == m_bWindowHasFocus)
+        return;
+
+    m_bWindowHasFocus = focused;
+
+    // only the buttons look different when unfocused
+    if (**PINACTIVECOLOR > 0) {
+        m_bButtonsDirty = true;
+        damageEntire();
+    }
+}
+
+void CHyprBar::invalidate(uint8_t diff) {
+    if (diff & BAR_RULE_DIFF_TITLE)
+        m_bTitleDirty = true;
+
+    if (diff & BAR_RULE_DIFF_BUTTONS)
+        m_bButtonsDirty = true;
+
+    if (!validMapped(m_pWindow))
+        return;
+
+    if (diff & BAR_RULE_DIFF_GEOMETRY) {
+        g_pDecorationPositioner->repositionDeco(this);
+
+        if (const auto PMONITOR = m_pWindow->m_monitor.lock(); PMONITOR)
+            PMONITOR->m_scheduledRecalc = true;
+    }
+
+    damageEntire();
+}
+
+void CHyprBar::onTitleChanged() {
+    m_bTitleChanged = true;
+    damageEntire();
+}
+
 CHyprBar::~CHyprBar() {
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pMouseButtonCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchDownCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchUpCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pTouchMoveCallback);
-    HyprlandAPI::unregisterCallback(PHANDLE, m_pMouseMoveCallback);
+    if (m_pTitleTimer)
+        g_pEventLoopManager->removeTimer(m_pTitleTimer);
+    if (m_pResizeTimer)
+        g_pEventLoopManager->removeTimer(m_pResizeTimer);
+
     std::erase(g_pGlobalState->bars, m_self);
 }
 
@@ -72,6 +107,7 @@ void CHyprBar::onPositioningReply(const SDecorationPositioningReply& reply) {
         m_bWindowSizeChanged = true;
 
     m_bAssignedBox = reply.assignedGeometry;
+    m_iGeometryGeneration++;
 }
 
 std::string CHyprBar::getDisplayName() {
@@ -81,6 +117,8 @@ std::string CHyprBar::getDisplayName() {
 bool CHyprBar::inputIsValid() {
     static auto* const PENABLED = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:enabled")->getDataStaticPtr();
 
+    TRACE_ZONE("CHyprBar::inputIsValid");
+
     if (!**PENABLED)
         return false;
 
@@ -88,11 +126,6 @@ bool CHyprBar::inputIsValid() {
         (g_pSeatManager->m_seatGrab && !g_pSeatManager->m_seatGrab->accepts(m_pWindow->m_wlSurface->resource())))
         return false;
 
-    const auto WINDOWATCURSOR = g_pCompositor->vectorToWindowUnified(g_pInputManager->getMouseCoordsInternal(), RESERVED_EXTENTS | INPUT_EXTENTS | ALLOW_FLOATING);
-
-    if (WINDOWATCURSOR != m_pWindow && m_pWindow != g_pCompositor->m_lastWindow)
-        return false;
-
     // check if input is on top or overlay shell layers
     auto     PMONITOR     = g_pCompositor->m_lastMonitor.lock();
     PHLLS    foundSurface = nullptr;
@@ -134,53 +167,97 @@ void CHyprBar::onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e) {
 }
 
 void CHyprBar::onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e) {
-    if (!m_bDragPending || !m_bTouchEv || e.touchID != m_touchId)
+    if (!m_input.tracksTouch(e.touchID))
         return;
 
+    // the window ends up where the finger was lifted, even if no frame was rendered since the last motion
+    applyTouchDrag();
+
     handleUpEvent(info);
 }
 
 void CHyprBar::onMouseMove(Vector2D coords) {
-    // ensure proper redraws of button icons on hover when using hardware cursors
-    static auto* const PICONONHOVER = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:icon_on_hover")->getDataStaticPtr();
-    if (**PICONONHOVER)
-        damageOnButtonHover();
-
-    if (!m_bDragPending || m_bTouchEv || !validMapped(m_pWindow) || m_touchId != 0)
+    if (!validMapped(m_pWindow) || !m_input.startMouseDrag())
         return;
 
-    m_bDragPending = false;
     handleMovement();
 }
 
 void CHyprBar::onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e) {
-    if (!m_bDragPending || !m_bTouchEv || !validMapped(m_pWindow) || e.touchID != m_touchId)
+    if (!m_input.tracksTouch(e.touchID) || !validMapped(m_pWindow))
         return;
 
-    auto PMONITOR     = m_pWindow->m_monitor.lock();
-    PMONITOR          = PMONITOR ? PMONITOR : g_pCompositor->m_lastMonitor.lock();
-    const auto COORDS = Vector2D(PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y);
+    auto PMONITOR = m_pWindow->m_monitor.lock();
+    PMONITOR      = PMONITOR ? PMONITOR : g_pCompositor->m_lastMonitor.lock();
 
-    if (!m_bDraggingThis) {
-        // Initial setup for dragging a window.
-        g_pKeybindManager->m_dispatchers["setfloating"]("activewindow");
-        g_pKeybindManager->m_dispatchers["resizewindowpixel"]("exact 50% 50%,activewindow");
-        // pin it so you can change workspaces while dragging a window
-        g_pKeybindManager->m_dispatchers["pin"]("activewindow");
+    // touchscreens send several of these per frame, only the last one before the frame is applied
+    if (m_input.moveTouch({PMONITOR->m_position.x + e.pos.x * PMONITOR->m_size.x, PMONITOR->m_position.y + e.pos.y * PMONITOR->m_size.y})) {
+        g_pGlobalState->pendingTouchDrags.emplace_back(m_self);
+        g_pCompositor->scheduleFrameForMonitor(PMONITOR);
     }
-    g_pKeybindManager->m_dispatchers["movewindowpixel"](std::format("exact {} {},activewindow", (int)(COORDS.x - (assignedBoxGlobal().w / 2)), (int)COORDS.y));
-    m_bDraggingThis = true;
 }
 
-void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownEvent> touchEvent) {
-    m_bTouchEv = touchEvent.has_value();
-    if (m_bTouchEv)
-        m_touchId = touchEvent.value().touchID;
+void CHyprBar::applyTouchDrag() {
+    const auto COORDS = m_input.takeTouchMove();
+
+    if (!COORDS || !validMapped(m_pWindow))
+        return;
+
+    TRACE_ZONE("CHyprBar::applyTouchDrag");
+
+    if (m_input.beginTouchDrag())
+        beginTouchDrag();
+
+    // what movewindowpixel exact does, without formatting the position for it to be parsed again
+    if (!m_pWindow->isFullscreen()) {
+        const Vector2D TARGET = {(int)(COORDS->x - (assignedBoxGlobal().w / 2)), (int)COORDS->y};
+        g_pLayoutManager->getCurrentLayout()->moveActiveWindow(TARGET - m_pWindow->m_realPosition->goal(), m_pWindow.lock());
+    }
+}
+
+void CHyprBar::beginTouchDrag() {
+    const auto  PWINDOW     = m_pWindow.lock();
+    const auto& DISPATCHERS = g_pGlobalState->dispatchers;
+
+    auto        PMONITOR = PWINDOW->m_monitor.lock();
+    PMONITOR             = PMONITOR ? PMONITOR : g_pCompositor->m_lastMonitor.lock();
+
+    // half the monitor, like resizewindowpixel exact 50% 50%
+    const Vector2D SIZE = (PMONITOR->m_size * 0.5).round();
+
+    if (!PWINDOW->m_isFloating) {
+        // float it at the drag size right away, instead of at its last floating size with a resize after
+        PWINDOW->m_lastFloatingSize = SIZE;
+        DISPATCHERS.setFloating("activewindow");
+    } else
+        g_pLayoutManager->getCurrentLayout()->resizeActiveWindow(SIZE - PWINDOW->m_realSize->goal(), CORNER_NONE, PWINDOW);
 
+    // pin it so you can change workspaces while dragging a window
+    if (!PWINDOW->m_pinned)
+        DISPATCHERS.pin("activewindow");
+}
+
+// looked up on every run, dispatchers of other plugins can come and go
+static void runBarAction(const SBarAction& action) {
+    if (action.dispatcher.empty())
+        return;
+
+    const auto IT = g_pKeybindManager->m_dispatchers.find(action.dispatcher);
+
+    if (IT == g_pKeybindManager->m_dispatchers.end()) {
+        Debug::log(ERR, "[hyprbars] no dispatcher named {}", action.dispatcher);
+        return;
+    }
+
+    if (const auto RESULT = IT->second(action.arg); !RESULT.success)
+        Debug::log(ERR, "[hyprbars] {} {} failed: {}", action.dispatcher, action.arg, RESULT.error);
+}
+
+void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownEvent> touchEvent) {
     const auto PWINDOW = m_pWindow.lock();
 
     auto       COORDS = cursorRelativeToBar();
-    if (m_bTouchEv) {
+    if (touchEvent) {
         ITouch::SDownEvent e        = touchEvent.value();
         auto               PMONITOR = g_pCompositor->getMonitorFromName(!e.device->m_boundOutput.empty() ? e.device->m_boundOutput : "");
         PMONITOR                    = PMONITOR ? PMONITOR : g_pCompositor->m_lastMonitor.lock();
@@ -191,23 +268,20 @@ void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownE
     static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
     static auto* const PBARPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
     static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
-    static auto* const PONDOUBLECLICK    = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:on_double_click")->getDataStaticPtr();
 
-    const bool         BUTTONSRIGHT    = std::string{*PALIGNBUTTONS} != "left";
-    const std::string  ON_DOUBLE_CLICK = *PONDOUBLECLICK;
+    const auto         GEOMETRY = BarLayout::SGeometry{
+        .barWidth      = assignedBoxGlobal().w,
+        .barHeight     = (double)**PHEIGHT,
+        .barPadding    = (double)**PBARPADDING,
+        .buttonPadding = (double)**PBARBUTTONPADDING,
+        .buttonsRight  = std::string{*PALIGNBUTTONS} != "left",
+    };
 
-    if (!VECINRECT(COORDS, 0, 0, assignedBoxGlobal().w, **PHEIGHT - 1)) {
+    const auto TOUCHID = touchEvent ? std::optional<int>{touchEvent->touchID} : std::nullopt;
+    const auto PRESS   = m_input.press(GEOMETRY, getButtons(), {COORDS.x, COORDS.y}, TOUCHID, !g_pGlobalState->doubleClickAction.dispatcher.empty(), Time::steadyNow());
 
-        if (m_bDraggingThis) {
-            if (m_bTouchEv)
-                g_pKeybindManager->m_dispatchers["settiled"]("activewindow");
-            g_pKeybindManager->m_dispatchers["mouse"]("0movewindow");
-            Debug::log(LOG, "[hyprbars] Dragging ended on {:x}", (uintptr_t)PWINDOW.get());
-        }
-
-        m_bDraggingThis = false;
-        m_bDragPending  = false;
-        m_bTouchEv      = false;
+    if (PRESS.type == BarInput::PRESS_OUTSIDE) {
+        endDrag(PRESS.dragEnd);
         return;
     }
 
@@ -217,130 +291,97 @@ void CHyprBar::handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownE
     if (PWINDOW->m_isFloating)
         g_pCompositor->changeWindowZOrder(PWINDOW, true);
 
-    info.cancelled   = true;
-    m_bCancelledDown = true;
+    info.cancelled             = true;
+    g_pGlobalState->pressedBar = m_self;
 
-    if (doButtonPress(PBARPADDING, PBARBUTTONPADDING, PHEIGHT, COORDS, BUTTONSRIGHT))
-        return;
-
-    if (!ON_DOUBLE_CLICK.empty() &&
-        std::chrono::duration_cast<std::chrono::milliseconds>(Time::steadyNow() - m_lastMouseDown).count() < 400 /* Arbitrary delay I found suitable */) {
-        g_pKeybindManager->m_dispatchers["exec"](ON_DOUBLE_CLICK);
-        m_bDragPending = false;
-    } else {
-        m_lastMouseDown = Time::steadyNow();
-        m_bDragPending  = true;
-    }
+    if (PRESS.type == BarInput::PRESS_BUTTON)
+        runBarAction(getButtons()[PRESS.button].action);
+    else if (PRESS.type == BarInput::PRESS_DOUBLE_CLICK)
+        runBarAction(g_pGlobalState->doubleClickAction);
 }
 
 void CHyprBar::handleUpEvent(SCallbackInfo& info) {
     if (m_pWindow.lock() != g_pCompositor->m_lastWindow.lock())
         return;
 
-    if (m_bCancelledDown)
-        info.cancelled = true;
-
-    m_bCancelledDown = false;
+    const auto RELEASE = m_input.release();
 
-    if (m_bDraggingThis) {
-        g_pKeybindManager->m_dispatchers["mouse"]("0movewindow");
-        m_bDraggingThis = false;
-        if (m_bTouchEv)
-            g_pKeybindManager->m_dispatchers["settiled"]("activewindow");
-
-        Debug::log(LOG, "[hyprbars] Dragging ended on {:x}", (uintptr_t)m_pWindow.lock().get());
-    }
+    if (RELEASE.cancel)
+        info.cancelled = true;
 
-    m_bDragPending = false;
-    m_bTouchEv     = false;
-    m_touchId      = 0;
+    endDrag(RELEASE.dragEnd);
 }
 
 void CHyprBar::handleMovement() {
-    g_pKeybindManager->m_dispatchers["mouse"]("1movewindow");
-    m_bDraggingThis = true;
+    g_pGlobalState->dispatchers.mouse("1movewindow");
     Debug::log(LOG, "[hyprbars] Dragging initiated on {:x}", (uintptr_t)m_pWindow.lock().get());
-    return;
 }
 
-bool CHyprBar::doButtonPress(Hyprlang::INT* const* PBARPADDING, Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PHEIGHT, Vector2D COORDS, const bool BUTTONSRIGHT) {
-    //check if on a button
-    float offset = **PBARPADDING;
-
-    for (auto& b : g_pGlobalState->buttons) {
-        const auto BARBUF     = Vector2D{(int)assignedBoxGlobal().w, **PHEIGHT};
-        Vector2D   currentPos = Vector2D{(BUTTONSRIGHT ? BARBUF.x - **PBARBUTTONPADDING - b.size - offset : offset), (BARBUF.y - b.size) / 2.0}.floor();
+void CHyprBar::endDrag(uint8_t dragEnd) {
+    if (dragEnd == BarInput::DRAG_END_NONE)
+        return;
 
-        if (VECINRECT(COORDS, currentPos.x, currentPos.y, currentPos.x + b.size + **PBARBUTTONPADDING, currentPos.y + b.size)) {
-            // hit on close
-            g_pKeybindManager->m_dispatchers["exec"](b.cmd);
-            return true;
-        }
+    g_pGlobalState->dispatchers.mouse("0movewindow");
+    if (dragEnd & BarInput::DRAG_END_TOUCH)
+        g_pGlobalState->dispatchers.setTiled("activewindow");
 
-        offset += **PBARBUTTONPADDING + b.size;
-    }
-    return false;
+    Debug::log(LOG, "[hyprbars] Dragging ended on {:x}", (uintptr_t)m_pWindow.lock().get());
 }
 
-void CHyprBar::renderText(SP<CTexture> out, const std::string& text, const CHyprColor& color, const Vector2D& bufferSize, const float scale, const int fontSize) {
-    const auto CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, bufferSize.x, bufferSize.y);
-    const auto CAIRO        = cairo_create(CAIROSURFACE);
-
-    // clear the pixmap
-    cairo_save(CAIRO);
-    cairo_set_operator(CAIRO, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(CAIRO);
-    cairo_restore(CAIRO);
-
-    // draw title using Pango
-    PangoLayout* layout = pango_cairo_create_layout(CAIRO);
-    pango_layout_set_text(layout, text.c_str(), -1);
-
-    PangoFontDescription* fontDesc = pango_font_description_from_string("sans");
-    pango_font_description_set_size(fontDesc, fontSize * scale * PANGO_SCALE);
-    pango_layout_set_font_description(layout, fontDesc);
-    pango_font_description_free(fontDesc);
-
-    const int maxWidth = bufferSize.x;
-
-    pango_layout_set_width(layout, maxWidth * PANGO_SCALE);
-    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_NONE);
-
-    cairo_set_source_rgba(CAIRO, color.r, color.g, color.b, color.a);
-
-    PangoRectangle ink_rect, logical_rect;
-    pango_layout_get_extents(layout, &ink_rect, &logical_rect);
+static BarRaster::SColor rasterColor(const CHyprColor& c) {
+    return {c.r, c.g, c.b, c.a};
+}
 
-    const int    layoutWidth  = ink_rect.width;
-    const int    layoutHeight = logical_rect.height;
+// null unless text_engine = atlas and the shader works, titles are rasterized with Pango then
+static CGlyphRenderer* glyphRenderer() {
+    if (g_pGlobalState->settings.textEngine != "atlas")
+        return nullptr;
 
-    const double xOffset = (bufferSize.x / 2.0 - layoutWidth / PANGO_SCALE / 2.0);
-    const double yOffset = (bufferSize.y / 2.0 - layoutHeight / PANGO_SCALE / 2.0);
+    if (!g_pGlyphRenderer)
+        g_pGlyphRenderer = makeUnique<CGlyphRenderer>();
 
-    cairo_move_to(CAIRO, xOffset, yOffset);
-    pango_cairo_show_layout(CAIRO, layout);
+    return g_pGlyphRenderer->ok() ? g_pGlyphRenderer.get() : nullptr;
+}
 
-    g_object_unref(layout);
+// linear filtering for textures rasterized below the monitor scale, see TEXTURE_DEGRADATION_HALF_RES
+static void uploadSurface(SP<CTexture> out, BarRaster::SPooledSurface* surface, bool linear = false) {
+    CScopedBarStat stat(BAR_STAT_UPLOAD);
+    g_pBarStats->onUpload((size_t)surface->width * surface->height * 4);
 
-    cairo_surface_flush(CAIROSURFACE);
+    cairo_surface_flush(surface->surface);
 
     // copy the data to an OpenGL texture we have
-    const auto DATA = cairo_image_surface_get_data(CAIROSURFACE);
     out->allocate();
+    out->m_size = {surface->width, surface->height};
     glBindTexture(GL_TEXTURE_2D, out->m_texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
 
 #ifndef GLES2
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+
+    // pooled surfaces can be wider than what we upload
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->stride / 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surface->width, surface->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, surface->data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#else
+    // no texture swizzle and no row length, reorder the bytes into a tightly packed copy ourselves
+    auto& packed = g_pGlobalState->uploadScratch;
+    packed.resize((size_t)surface->width * surface->height * 4);
+    Swizzle::bgraToRgba(surface->data, surface->stride, packed.data(), surface->width * 4, surface->width, surface->height);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surface->width, surface->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, packed.data());
 #endif
+}
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bufferSize.x, bufferSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, DATA);
+void CHyprBar::renderText(SP<CTexture> out, const std::string& text, const CHyprColor& color, const Vector2D& bufferSize, const float scale, const int fontSize) {
+    const auto SURFACE = g_pGlobalState->rasterSurfaces.acquire(bufferSize.x, bufferSize.y);
 
-    // delete cairo
-    cairo_destroy(CAIRO);
-    cairo_surface_destroy(CAIROSURFACE);
+    BarRaster::renderText(SURFACE->cairo, SURFACE->width, SURFACE->height, text, rasterColor(color), fontSize * scale);
+
+    uploadSurface(out, SURFACE);
+
+    g_pGlobalState->rasterSurfaces.release(SURFACE);
 }
 
 void CHyprBar::renderBarTitle(const Vector2D& bufferSize, const float scale) {
@@ -352,91 +393,190 @@ void CHyprBar::renderBarTitle(const Vector2D& bufferSize, const float scale) {
     static auto* const PBARPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
     static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
 
-    const bool         BUTTONSRIGHT = std::string{*PALIGNBUTTONS} != "left";
+    TRACE_ZONE("CHyprBar::renderBarTitle");
 
     const auto         PWINDOW = m_pWindow.lock();
 
     const auto         BORDERSIZE = PWINDOW->getRealBorderSize();
 
-    float              buttonSizes = **PBARBUTTONPADDING;
-    for (auto& b : g_pGlobalState->buttons) {
-        buttonSizes += b.size + **PBARBUTTONPADDING;
+    const float        buttonSizes = **PBARBUTTONPADDING * (float)(getButtons().size() + 1) + getButtonsWidth();
+
+    const CHyprColor   COLOR = m_bForcedTitleColor.value_or(**PCOLOR);
+
+    BarRaster::STitle  title = {
+        .text         = m_szLastTitle,
+        .font         = *PFONT,
+        .fontSize     = **PSIZE * scale,
+        .color        = rasterColor(COLOR),
+        .alignLeft    = std::string{*PALIGN} == "left",
+        .buttonsRight = std::string{*PALIGNBUTTONS} != "left",
+        .barPadding   = **PBARPADDING * scale,
+        .buttonsWidth = buttonSizes * scale,
+        .borderSize   = BORDERSIZE * scale,
+    };
+
+    CScopedBarStat                stat(BAR_STAT_TITLE_RASTER);
+    g_pBarStats->onTitleRender();
+
+    const int                     MAXWIDTH = BarRaster::titleMaxWidth(bufferSize.x, title);
+    const BarRaster::CTitleLayout LAYOUT(g_pGlobalState->rasterSurfaces.scratchContext(), title, MAXWIDTH);
+
+    m_titleRaster = {
+        .title        = title,
+        .maxWidth     = MAXWIDTH,
+        .width        = LAYOUT.width,
+        .height       = LAYOUT.height,
+        .naturalWidth = LAYOUT.naturalWidth,
+        .ellipsized   = LAYOUT.ellipsized,
+        .rasterPos    = {LAYOUT.rasterX, LAYOUT.rasterY},
+        .scale        = scale,
+    };
+
+    // nothing to upload, the glyphs are in the atlas already or added to it
+    if (const auto GLYPHS = glyphRenderer()) {
+        auto& atlas = GLYPHS->atlas();
+
+        // if the page started over halfway through, the glyphs before that point at what's gone. A title
+        // never needs a whole page, so the second go fits, and if not the epoch is outdated and it's tried again.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            m_titleRaster.glyphsEpoch = atlas.epoch();
+            atlas.layout(LAYOUT, m_titleRaster.glyphs);
+
+            if (m_titleRaster.glyphsEpoch == atlas.epoch())
+                break;
+        }
+
+        if (m_pTextTex->m_texID != 0)
+            m_pTextTex = makeShared<CTexture>();
+
+        return;
     }
 
-    const auto       scaledSize        = **PSIZE * scale;
-    const auto       scaledBorderSize  = BORDERSIZE * scale;
-    const auto       scaledButtonsSize = buttonSizes * scale;
-    const auto       scaledButtonsPad  = **PBARBUTTONPADDING * scale;
-    const auto       scaledBarPadding  = **PBARPADDING * scale;
+    // identical titles share a texture when we're short on texture memory
+    const bool  SHARE = g_pTextureResidency->degradation() >= TEXTURE_DEGRADATION_SHARE_TITLES;
+    std::string key;
 
-    const CHyprColor COLOR = m_bForcedTitleColor.value_or(**PCOLOR);
+    if (SHARE) {
+        // the raster scale picks the filtering, a half res texture isn't handed out once that's over
+        key = std::format("{}\n{}\n{}\n{:x}\n{}\n{}", title.text, title.font, title.fontSize, COLOR.getAsHex(), m_titleRaster.maxWidth, g_pTextureResidency->rasterScale());
 
-    const auto       CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, bufferSize.x, bufferSize.y);
-    const auto       CAIRO        = cairo_create(CAIROSURFACE);
+        if (const auto TEX = g_pTextureResidency->sharedTitle(key); TEX) {
+            m_pTextTex = TEX;
+            return;
+        }
+    }
 
-    // clear the pixmap
-    cairo_save(CAIRO);
-    cairo_set_operator(CAIRO, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(CAIRO);
-    cairo_restore(CAIRO);
+    // never draw into a texture other bars are showing, nor into one that's still shared under the old title
+    if (SHARE || m_pTextTex.strongRef() > 1)
+        m_pTextTex = makeShared<CTexture>();
 
-    // draw title using Pango
-    PangoLayout* layout = pango_cairo_create_layout(CAIRO);
-    pango_layout_set_text(layout, m_szLastTitle.c_str(), -1);
+    // the texture only covers the text, it's placed in the bar when drawn
+    const auto SURFACE = g_pGlobalState->rasterSurfaces.acquire(LAYOUT.rasterWidth, LAYOUT.rasterHeight);
 
-    PangoFontDescription* fontDesc = pango_font_description_from_string(*PFONT);
-    pango_font_description_set_size(fontDesc, scaledSize * PANGO_SCALE);
-    pango_layout_set_font_description(layout, fontDesc);
-    pango_font_description_free(fontDesc);
+    cairo_set_source_rgba(SURFACE->cairo, title.color.r, title.color.g, title.color.b, title.color.a);
+    LAYOUT.render(SURFACE->cairo, -LAYOUT.rasterX, -LAYOUT.rasterY);
 
-    PangoContext* context = pango_layout_get_context(layout);
-    pango_context_set_base_dir(context, PANGO_DIRECTION_NEUTRAL);
+    uploadSurface(m_pTextTex, SURFACE, g_pTextureResidency->rasterScale() < 1.F);
 
-    const int paddingTotal = scaledBarPadding * 2 + scaledButtonsSize + (std::string{*PALIGN} != "left" ? scaledButtonsSize : 0);
-    const int maxWidth     = std::clamp(static_cast<int>(bufferSize.x - paddingTotal), 0, INT_MAX);
+    g_pGlobalState->rasterSurfaces.release(SURFACE);
 
-    pango_layout_set_width(layout, maxWidth * PANGO_SCALE);
-    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+    if (SHARE)
+        g_pTextureResidency->shareTitle(key, m_pTextTex);
+}
 
-    cairo_set_source_rgba(CAIRO, COLOR.r, COLOR.g, COLOR.b, COLOR.a);
+bool CHyprBar::titleLayoutChanged(const Vector2D& bufferSize, const float scale) {
+    if (scale != m_titleRaster.scale)
+        return true;
 
-    int layoutWidth, layoutHeight;
-    pango_layout_get_size(layout, &layoutWidth, &layoutHeight);
-    const int xOffset = std::string{*PALIGN} == "left" ? std::round(scaledBarPadding + (BUTTONSRIGHT ? 0 : scaledButtonsSize)) :
-                                                         std::round(((bufferSize.x - scaledBorderSize) / 2.0 - layoutWidth / PANGO_SCALE / 2.0));
-    const int yOffset = std::round((bufferSize.y / 2.0 - layoutHeight / PANGO_SCALE / 2.0));
+    // the ellipsis appears or goes away
+    const bool FITS = m_titleRaster.naturalWidth <= BarRaster::titleMaxWidth(bufferSize.x, m_titleRaster.title);
+    return FITS == m_titleRaster.ellipsized;
+}
 
-    cairo_move_to(CAIRO, xOffset, yOffset);
-    pango_cairo_show_layout(CAIRO, layout);
+void CHyprBar::useScale(float monitorScale) {
+    // whatever was invalidated since the other variants were drawn applies to them as well
+    for (auto& v : m_otherScales) {
+        v.titleDirty   = v.titleDirty || m_bTitleDirty;
+        v.buttonsDirty = v.buttonsDirty || m_bButtonsDirty;
+        v.sizeChanged  = v.sizeChanged || m_bWindowSizeChanged;
+    }
 
-    g_object_unref(layout);
+    if (monitorScale == m_fMonitorScale)
+        return;
 
-    cairo_surface_flush(CAIROSURFACE);
+    if (m_fMonitorScale == 0) {
+        m_fMonitorScale = monitorScale;
+        return;
+    }
 
-    // copy the data to an OpenGL texture we have
-    const auto DATA = cairo_image_surface_get_data(CAIROSURFACE);
-    m_pTextTex->allocate();
-    glBindTexture(GL_TEXTURE_2D, m_pTextTex->m_texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    auto it = std::ranges::find(m_otherScales, monitorScale, &SScaleVariant::monitorScale);
+    if (it == m_otherScales.end())
+        it = m_otherScales.insert(m_otherScales.end(), SScaleVariant{.monitorScale = monitorScale, .textTex = makeShared<CTexture>(), .buttonsTex = makeShared<CTexture>()});
+
+    // swapped instead of copied, a window spanning two monitors does this twice a frame
+    std::swap(m_pTextTex, it->textTex);
+    std::swap(m_pButtonsTex, it->buttonsTex);
+    std::swap(m_titleRaster, it->titleRaster);
+    std::swap(m_iRasterVisibleButtons, it->rasterVisibleButtons);
+    std::swap(m_fButtonsRasterScale, it->buttonsRasterScale);
+    std::swap(m_bTitleDirty, it->titleDirty);
+    std::swap(m_bButtonsDirty, it->buttonsDirty);
+    std::swap(m_bWindowSizeChanged, it->sizeChanged);
+
+    it->monitorScale = m_fMonitorScale;
+    it->lastDrawn    = Time::steadyNow();
+    m_fMonitorScale  = monitorScale;
+
+    // the title may have been re-rendered for another monitor in the meantime
+    if (m_titleRaster.title.text != m_szLastTitle)
+        m_bTitleDirty = true;
+}
 
-#ifndef GLES2
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-#endif
+void CHyprBar::scheduleSettledRaster() {
+    // one crisp re-render when the resize or animation is over, the textures were only moved around until then
+    if (!m_pResizeTimer) {
+        m_pResizeTimer = makeShared<CEventLoopTimer>(
+            std::nullopt,
+            [this](SP<CEventLoopTimer> self, void* data) {
+                m_bTitleDirty   = true;
+                m_bButtonsDirty = true;
+                damageEntire();
+            },
+            nullptr);
+        g_pEventLoopManager->addTimer(m_pResizeTimer);
+    }
+
+    m_pResizeTimer->updateTimeout(std::chrono::milliseconds(150));
+}
+
+bool CHyprBar::titleRefreshDue() {
+    static auto* const PRATE = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:title_refresh_rate")->getDataStaticPtr();
+
+    if (**PRATE <= 0)
+        return true;
+
+    const auto INTERVAL = std::chrono::duration_cast<Time::steady_dur>(std::chrono::microseconds(1000000 / **PRATE));
+    const auto SINCE    = Time::steadyNow() - m_lastTitleRender;
+
+    if (SINCE >= INTERVAL)
+        return true;
+
+    // too early, keep the current title up and come back for whatever the title is by then
+    if (!m_pTitleTimer) {
+        m_pTitleTimer = makeShared<CEventLoopTimer>(std::nullopt, [this](SP<CEventLoopTimer> self, void* data) { damageEntire(); }, nullptr);
+        g_pEventLoopManager->addTimer(m_pTitleTimer);
+    }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bufferSize.x, bufferSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, DATA);
+    m_pTitleTimer->updateTimeout(INTERVAL - SINCE);
 
-    // delete cairo
-    cairo_destroy(CAIRO);
-    cairo_surface_destroy(CAIROSURFACE);
+    return false;
 }
 
 size_t CHyprBar::getVisibleButtonCount(Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PBARPADDING, const Vector2D& bufferSize, const float scale) {
     float  availableSpace = bufferSize.x - **PBARPADDING * scale * 2;
     size_t count          = 0;
 
-    for (const auto& button : g_pGlobalState->buttons) {
+    for (const auto& button : getButtons()) {
         const float buttonSpace = (button.size + **PBARBUTTONPADDING) * scale;
         if (availableSpace >= buttonSpace) {
             count++;
@@ -454,58 +594,39 @@ void CHyprBar::renderBarButtons(const Vector2D& bufferSize, const float scale) {
     static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
     static auto* const PINACTIVECOLOR    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:inactive_button_color")->getDataStaticPtr();
 
-    const bool         BUTTONSRIGHT = std::string{*PALIGNBUTTONS} != "left";
-    const auto         visibleCount = getVisibleButtonCount(PBARBUTTONPADDING, PBARPADDING, bufferSize, scale);
+    TRACE_ZONE("CHyprBar::renderBarButtons");
 
-    const auto         CAIROSURFACE = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, bufferSize.x, bufferSize.y);
-    const auto         CAIRO        = cairo_create(CAIROSURFACE);
+    const auto         visibleCount = getVisibleButtonCount(PBARBUTTONPADDING, PBARPADDING, bufferSize, scale);
 
-    // clear the pixmap
-    cairo_save(CAIRO);
-    cairo_set_operator(CAIRO, CAIRO_OPERATOR_CLEAR);
-    cairo_paint(CAIRO);
-    cairo_restore(CAIRO);
+    BarRaster::SButtons buttons = {
+        .barPadding    = **PBARPADDING * scale,
+        .buttonPadding = **PBARBUTTONPADDING * scale,
+        .right         = std::string{*PALIGNBUTTONS} != "left",
+    };
 
-    // draw buttons
-    int offset = **PBARPADDING * scale;
     for (size_t i = 0; i < visibleCount; ++i) {
-        const auto& button           = g_pGlobalState->buttons[i];
-        const auto  scaledButtonSize = button.size * scale;
-        const auto  scaledButtonsPad = **PBARBUTTONPADDING * scale;
-
-        const auto  pos   = Vector2D{BUTTONSRIGHT ? bufferSize.x - offset - scaledButtonSize / 2.0 : offset + scaledButtonSize / 2.0, bufferSize.y / 2.0}.floor();
-        auto        color = button.bgcol;
+        const auto& button = getButtons()[i];
+        auto        color  = button.bgcol;
 
         if (**PINACTIVECOLOR > 0) {
             color = m_bWindowHasFocus ? color : CHyprColor(**PINACTIVECOLOR);
-            if (button.userfg && button.iconTex->m_texID != 0)
-                button.iconTex->destroyTexture();
+            if (button.userfg)
+                button.iconTextures->destroy();
         }
 
-        cairo_set_source_rgba(CAIRO, color.r, color.g, color.b, color.a);
-        cairo_arc(CAIRO, pos.x, pos.y, scaledButtonSize / 2, 0, 2 * M_PI);
-        cairo_fill(CAIRO);
-
-        offset += scaledButtonsPad + scaledButtonSize;
+        buttons.buttons.emplace_back(BarRaster::SButton{.size = button.size * scale, .color = rasterColor(color)});
     }
 
-    // copy the data to an OpenGL texture we have
-    const auto DATA = cairo_image_surface_get_data(CAIROSURFACE);
-    m_pButtonsTex->allocate();
-    glBindTexture(GL_TEXTURE_2D, m_pButtonsTex->m_texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    m_iRasterVisibleButtons = visibleCount;
+    m_fButtonsRasterScale   = scale;
 
-#ifndef GLES2
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
-#endif
+    const auto SURFACE = g_pGlobalState->rasterSurfaces.acquire(bufferSize.x, bufferSize.y);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bufferSize.x, bufferSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, DATA);
+    BarRaster::renderButtons(SURFACE->cairo, SURFACE->width, SURFACE->height, buttons);
 
-    // delete cairo
-    cairo_destroy(CAIRO);
-    cairo_surface_destroy(CAIROSURFACE);
+    uploadSurface(m_pButtonsTex, SURFACE, g_pTextureResidency->rasterScale() < 1.F);
+
+    g_pGlobalState->rasterSurfaces.release(SURFACE);
 }
 
 void CHyprBar::renderBarButtonsText(CBox* barBox, const float scale, const float a) {
@@ -515,40 +636,49 @@ void CHyprBar::renderBarButtonsText(CBox* barBox, const float scale, const float
     static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
     static auto* const PICONONHOVER      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:icon_on_hover")->getDataStaticPtr();
 
+    CScopedBarStat     stat(BAR_STAT_ICONS);
+
     const bool         BUTTONSRIGHT = std::string{*PALIGNBUTTONS} != "left";
     const auto         visibleCount = getVisibleButtonCount(PBARBUTTONPADDING, PBARPADDING, Vector2D{barBox->w, barBox->h}, scale);
     const auto         COORDS       = cursorRelativeToBar();
 
-    int                offset        = **PBARPADDING * scale;
-    float              noScaleOffset = **PBARPADDING;
+    const auto         GEOMETRY = BarLayout::SGeometry{
+        .barWidth      = assignedBoxGlobal().w,
+        .barHeight     = (double)**PHEIGHT,
+        .barPadding    = (double)**PBARPADDING,
+        .buttonPadding = (double)**PBARBUTTONPADDING,
+        .buttonsRight  = BUTTONSRIGHT,
+    };
+    const int HOVEREDBUTTON = BarLayout::buttonAt(GEOMETRY, getButtons(), COORDS.x, COORDS.y);
+
+    int       offset = **PBARPADDING * scale;
 
     for (size_t i = 0; i < visibleCount; ++i) {
-        auto&      button           = g_pGlobalState->buttons[i];
+        auto&      button           = getButtons()[i];
         const auto scaledButtonSize = button.size * scale;
         const auto scaledButtonsPad = **PBARBUTTONPADDING * scale;
 
-        // check if hovering here
-        const auto BARBUF     = Vector2D{(int)assignedBoxGlobal().w, **PHEIGHT};
-        Vector2D   currentPos = Vector2D{(BUTTONSRIGHT ? BARBUF.x - **PBARBUTTONPADDING - button.size - noScaleOffset : noScaleOffset), (BARBUF.y - button.size) / 2.0}.floor();
-        bool       hovering   = VECINRECT(COORDS, currentPos.x, currentPos.y, currentPos.x + button.size + **PBARBUTTONPADDING, currentPos.y + button.size);
-        noScaleOffset += **PBARBUTTONPADDING + button.size;
+        const bool hovering         = HOVEREDBUTTON == (int)i;
 
-        if (button.iconTex->m_texID == 0 /* icon is not rendered */ && !button.icon.empty()) {
+        // rasterized for every monitor scale it's drawn at
+        const auto ICONTEX = button.iconTextures->get(scale);
+
+        if (ICONTEX->m_texID == 0 /* icon is not rendered */ && !button.icon.empty()) {
             // render icon
             const Vector2D BUFSIZE = {scaledButtonSize, scaledButtonSize};
             auto           fgcol   = button.userfg ? button.fgcol : (button.bgcol.r + button.bgcol.g + button.bgcol.b < 1) ? CHyprColor(0xFFFFFFFF) : CHyprColor(0xFF000000);
 
-            renderText(button.iconTex, button.icon, fgcol, BUFSIZE, scale, button.size * 0.62);
+            renderText(ICONTEX, button.icon, fgcol, BUFSIZE, scale, button.size * 0.62);
         }
 
-        if (button.iconTex->m_texID == 0)
+        if (ICONTEX->m_texID == 0)
             continue;
 
         CBox pos = {barBox->x + (BUTTONSRIGHT ? barBox->width - offset - scaledButtonSize : offset), barBox->y + (barBox->height - scaledButtonSize) / 2.0, scaledButtonSize,
                     scaledButtonSize};
 
         if (!**PICONONHOVER || (**PICONONHOVER && m_iButtonHoverState > 0))
-            g_pHyprOpenGL->renderTexture(button.iconTex, pos, {.a = a});
+            g_pHyprOpenGL->renderTexture(ICONTEX, pos, {.a = a});
         offset += scaledButtonsPad + scaledButtonSize;
 
         bool currentBit = (m_iButtonHoverState & (1 << i)) != 0;
@@ -556,6 +686,7 @@ void CHyprBar::renderBarButtonsText(CBox* barBox, const float scale, const float
             m_iButtonHoverState ^= (1 << i);
             // damage to get rid of some artifacts when icons are "hidden"
             damageEntire();
+            g_pBarStats->onHoverDamage();
         }
     }
 }
@@ -563,11 +694,6 @@ void CHyprBar::renderBarButtonsText(CBox* barBox, const float scale, const float
 void CHyprBar::draw(PHLMONITOR pMonitor, const float& a) {
     static auto* const PENABLED = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:enabled")->getDataStaticPtr();
 
-    if (m_bLastEnabledState != **PENABLED) {
-        m_bLastEnabledState = **PENABLED;
-        g_pDecorationPositioner->repositionDeco(this);
-    }
-
     if (m_hidden || !validMapped(m_pWindow) || !**PENABLED)
         return;
 
@@ -576,11 +702,96 @@ void CHyprBar::draw(PHLMONITOR pMonitor, const float& a) {
     if (!PWINDOW->m_windowData.decorate.valueOrDefault())
         return;
 
+    // not drawing also lets the textures of a bar that stays covered go cold, see CTextureResidency
+    if (occluded(pMonitor)) {
+        g_pBarStats->onOccluded();
+        return;
+    }
+
     auto data = CBarPassElement::SBarData{this, a};
     g_pHyprRenderer->m_renderPass.add(makeUnique<CBarPassElement>(data));
 }
 
+// only walked for monitors that have a bar drawn, once a frame
+static const std::vector<SOccluder>& occludersFor(PHLMONITOR pMonitor) {
+    auto& occluders = g_pGlobalState->occluders;
+
+    if (g_pGlobalState->occludersFrame == g_pGlobalState->frame)
+        return occluders;
+
+    g_pGlobalState->occludersFrame = g_pGlobalState->frame;
+    occluders.clear();
+
+    // tiled windows are drawn below the floating ones and can't cover their bars. Maximized ones still
+    // count, they cover the tiled bars.
+    if (std::exchange(g_pGlobalState->occluderWindowsDirty, false)) {
+        g_pGlobalState->occluderWindows.clear();
+        for (const auto& w : g_pCompositor->m_windows) {
+            if (w->m_isFloating || w->isFullscreen())
+                g_pGlobalState->occluderWindows.emplace_back(w);
+        }
+    }
+
+    for (const auto& ref : g_pGlobalState->occluderWindows) {
+        const auto w = ref.lock();
+
+        if (!validMapped(w) || w->isHidden() || w->m_fadingOut || w->m_monitor != pMonitor || (!w->m_isFloating && !w->isFullscreen()))
+            continue;
+
+        // nor can anything in the middle of a workspace switch
+        const auto PWORKSPACE = w->m_workspace;
+
+        if (!PWORKSPACE || !PWORKSPACE->isVisible() || PWORKSPACE->m_renderOffset->isBeingAnimated() || !w->opaque())
+            continue;
+
+        CBox box = {w->m_realPosition->value() + (w->m_pinned ? Vector2D{} : PWORKSPACE->m_renderOffset->value()), w->m_realSize->value()};
+        occluders.emplace_back(SOccluder{.window = w, .box = box.expand(-w->rounding()), .fullscreen = w->isEffectiveInternalFSMode(FSMODE_FULLSCREEN)});
+    }
+
+    return occluders;
+}
+
+bool CHyprBar::occluded(PHLMONITOR pMonitor) {
+    const auto PWINDOW = m_pWindow.lock();
+
+    // pinned windows are drawn over everything, and snapshots of the window alone
+    if (PWINDOW->m_pinned || g_pHyprRenderer->m_renderingSnapshot)
+        return false;
+
+    const auto& OCCLUDERS = occludersFor(pMonitor);
+
+    if (OCCLUDERS.empty())
+        return false;
+
+    const auto BOX = assignedBoxGlobal();
+
+    for (const auto& o : OCCLUDERS) {
+        const auto POCCLUDER = o.window.lock();
+
+        if (!POCCLUDER || POCCLUDER == PWINDOW || POCCLUDER->m_workspace != PWINDOW->m_workspace)
+            continue;
+
+        // the order of the floating windows isn't known here, only that they're above the tiled ones.
+        // Fullscreen windows are above both, apart from floating windows opened over them.
+        if (PWINDOW->m_isFloating && (!o.fullscreen || PWINDOW->m_createdOverFullscreen))
+            continue;
+
+        if (BOX.x >= o.box.x && BOX.y >= o.box.y && BOX.x + BOX.w <= o.box.x + o.box.w && BOX.y + BOX.h <= o.box.y + o.box.h)
+            return true;
+    }
+
+    return false;
+}
+
 void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
+    TRACE_ZONE("CHyprBar::renderPass");
+    CScopedBarStat     stat(BAR_STAT_OTHER);
+    g_pBarStats->onRenderPass();
+
+    m_lastDrawn = Time::steadyNow();
+
+    useScale(pMonitor->m_scale);
+
     const auto         PWINDOW = m_pWindow.lock();
 
     static auto* const PCOLOR            = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_color")->getDataStaticPtr();
@@ -590,15 +801,8 @@ void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
     static auto* const PENABLETITLE      = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_title_enabled")->getDataStaticPtr();
     static auto* const PENABLEBLUR       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_blur")->getDataStaticPtr();
     static auto* const PENABLEBLURGLOBAL = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "decoration:blur:enabled")->getDataStaticPtr();
-    static auto* const PINACTIVECOLOR    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:inactive_button_color")->getDataStaticPtr();
-
-    if (**PINACTIVECOLOR > 0) {
-        bool currentWindowFocus = PWINDOW == g_pCompositor->m_lastWindow.lock();
-        if (currentWindowFocus != m_bWindowHasFocus) {
-            m_bWindowHasFocus = currentWindowFocus;
-            m_bButtonsDirty   = true;
-        }
-    }
+    static auto* const PBARPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
+    static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
 
     const CHyprColor DEST_COLOR = m_bForcedBarColor.value_or(**PCOLOR);
     if (DEST_COLOR != m_cRealBarColor->goal())
@@ -610,10 +814,8 @@ void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
     const bool BUTTONSRIGHT = std::string{*PALIGNBUTTONS} != "left";
     const bool SHOULDBLUR   = **PENABLEBLUR && **PENABLEBLURGLOBAL && color.a < 1.F;
 
-    if (**PHEIGHT < 1) {
-        m_iLastHeight = **PHEIGHT;
+    if (**PHEIGHT < 1)
         return;
-    }
 
     const auto PWORKSPACE      = PWINDOW->m_workspace;
     const auto WORKSPACEOFFSET = PWORKSPACE && !PWINDOW->m_pinned ? PWORKSPACE->m_renderOffset->value() : Vector2D();
@@ -628,6 +830,10 @@ void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
 
     const auto BARBUF = DECOBOX.size() * pMonitor->m_scale;
 
+    // titles and buttons may be rasterized below the monitor scale to save texture memory, and stretched
+    const auto RASTERSCALE = pMonitor->m_scale * g_pTextureResidency->rasterScale();
+    auto       RASTERBUF   = DECOBOX.size() * RASTERSCALE;
+
     CBox       titleBarBox = {DECOBOX.x - pMonitor->m_position.x, DECOBOX.y - pMonitor->m_position.y, DECOBOX.w,
                               DECOBOX.h + ROUNDING * 3 /* to fill the bottom cuz we can't disable rounding there */};
 
@@ -638,42 +844,65 @@ void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
 
     g_pHyprOpenGL->scissor(titleBarBox);
 
-    if (ROUNDING) {
-        // the +1 is a shit garbage temp fix until renderRect supports an alpha matte
-        CBox windowBox = {PWINDOW->m_realPosition->value().x + PWINDOW->m_floatingOffset.x - pMonitor->m_position.x + 1,
-                          PWINDOW->m_realPosition->value().y + PWINDOW->m_floatingOffset.y - pMonitor->m_position.y + 1, PWINDOW->m_realSize->value().x - 2,
-                          PWINDOW->m_realSize->value().y - 2};
+    {
+        CScopedBarStat rectStat(BAR_STAT_RECT);
 
-        if (windowBox.w < 1 || windowBox.h < 1)
-            return;
+        if (ROUNDING) {
+            // the +1 is a shit garbage temp fix until renderRect supports an alpha matte
+            CBox windowBox = {PWINDOW->m_realPosition->value().x + PWINDOW->m_floatingOffset.x - pMonitor->m_position.x + 1,
+                              PWINDOW->m_realPosition->value().y + PWINDOW->m_floatingOffset.y - pMonitor->m_position.y + 1, PWINDOW->m_realSize->value().x - 2,
+                              PWINDOW->m_realSize->value().y - 2};
 
-        glClearStencil(0);
-        glClear(GL_STENCIL_BUFFER_BIT);
+            if (windowBox.w < 1 || windowBox.h < 1)
+                return;
 
-        g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, true);
+            glClearStencil(0);
+            glClear(GL_STENCIL_BUFFER_BIT);
 
-        glStencilFunc(GL_ALWAYS, 1, -1);
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+            g_pHyprOpenGL->setCapStatus(GL_STENCIL_TEST, true);
 
-        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glStencilFunc(GL_ALWAYS, 1, -1);
+            glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-        windowBox.translate(WORKSPACEOFFSET).scale(pMonitor->m_scale).round();
-        g_pHyprOpenGL->renderRect(windowBox, CHyprColor(0, 0, 0, 0), {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower()});
-        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
 
-        glStencilFunc(GL_NOTEQUAL, 1, -1);
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-    }
+            windowBox.translate(WORKSPACEOFFSET).scale(pMonitor->m_scale).round();
+            g_pHyprOpenGL->renderRect(windowBox, CHyprColor(0, 0, 0, 0), {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower()});
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+            glStencilFunc(GL_NOTEQUAL, 1, -1);
+            glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+        }
 
-    if (SHOULDBLUR)
-        g_pHyprOpenGL->renderRect(titleBarBox, color, {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower(), .blur = true, .blurA = a});
-    else
-        g_pHyprOpenGL->renderRect(titleBarBox, color, {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower()});
+        if (SHOULDBLUR)
+            g_pHyprOpenGL->renderRect(titleBarBox, color, {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower(), .blur = true, .blurA = a});
+        else
+            g_pHyprOpenGL->renderRect(titleBarBox, color, {.round = scaledRounding, .roundingPower = m_pWindow->roundingPower()});
+    }
 
     // render title
-    if (**PENABLETITLE && (m_szLastTitle != PWINDOW->m_title || m_bWindowSizeChanged || m_pTextTex->m_texID == 0 || m_bTitleColorChanged)) {
-        m_szLastTitle = PWINDOW->m_title;
-        renderBarTitle(BARBUF, pMonitor->m_scale);
+    // a resize only re-renders when the ellipsis comes or goes, otherwise the texture is moved until the resize settles.
+    // While animating not even that, and missing textures are rasterized for the size the window animates to.
+    // A changed title alone is rate limited, anything else re-renders right away.
+    const bool ANIMATING = PWINDOW->m_animatingIn || PWINDOW->m_fadingOut || PWINDOW->m_realSize->isBeingAnimated() || (PWORKSPACE && PWORKSPACE->m_renderOffset->isBeingAnimated());
+
+    // atlas titles go missing when the atlas started over
+    const auto GLYPHS       = glyphRenderer();
+    const bool TITLEMISSING = GLYPHS ? m_titleRaster.glyphsEpoch != GLYPHS->atlas().epoch() : m_pTextTex->m_texID == 0;
+
+    if (m_bWindowSizeChanged || (ANIMATING && (TITLEMISSING || m_pButtonsTex->m_texID == 0)))
+        scheduleSettledRaster();
+
+    if (ANIMATING)
+        RASTERBUF.x = PWINDOW->m_realSize->goal().x * RASTERSCALE;
+
+    const bool RESIZED     = m_bWindowSizeChanged && !ANIMATING;
+    const bool TITLEFORCED = TITLEMISSING || m_bTitleDirty || (RESIZED && titleLayoutChanged(RASTERBUF, RASTERSCALE));
+    if (**PENABLETITLE && (TITLEFORCED || (m_bTitleChanged && titleRefreshDue()))) {
+        m_szLastTitle     = PWINDOW->m_title;
+        m_bTitleChanged   = false;
+        m_lastTitleRender = Time::steadyNow();
+        renderBarTitle(RASTERBUF, RASTERSCALE);
     }
 
     if (ROUNDING) {
@@ -686,28 +915,58 @@ void CHyprBar::renderPass(PHLMONITOR pMonitor, const float& a) {
     }
 
     CBox textBox = {titleBarBox.x, titleBarBox.y, (int)BARBUF.x, (int)BARBUF.y};
-    if (**PENABLETITLE)
-        g_pHyprOpenGL->renderTexture(m_pTextTex, textBox, {.a = a});
-
-    if (m_bButtonsDirty || m_bWindowSizeChanged) {
-        renderBarButtons(BARBUF, pMonitor->m_scale);
-        m_bButtonsDirty = false;
+    if (**PENABLETITLE) {
+        // the texture only covers the text, place it for the current bar size
+        const auto& TR       = m_titleRaster;
+        const auto  RATIO    = pMonitor->m_scale / TR.scale;
+        const auto [X, Y]    = BarRaster::titleOffset(DECOBOX.w * TR.scale, DECOBOX.h * TR.scale, TR.title, TR.width, TR.height);
+        const auto  MAXWIDTH = BarRaster::titleMaxWidth(DECOBOX.w * TR.scale, TR.title);
+
+        CBox        titleBox = {textBox.x + (X + TR.rasterPos.x) * RATIO, textBox.y + (Y + TR.rasterPos.y) * RATIO, m_pTextTex->m_size.x * RATIO, m_pTextTex->m_size.y * RATIO};
+
+        // an ellipsized title in a shrinking bar is wider than it may be until the resize settles, crop it
+        const CBox CROP = TR.width > MAXWIDTH ? CBox{textBox.x + X * RATIO, textBox.y, MAXWIDTH * RATIO, textBox.h}.intersection(titleBarBox) : titleBarBox;
+
+        if (GLYPHS) {
+            const auto& C = TR.title.color;
+            GLYPHS->draw(TR.glyphs, {textBox.x + X * RATIO, textBox.y + Y * RATIO}, RATIO, CHyprColor(C.r, C.g, C.b, C.a * a), CROP);
+            g_pHyprOpenGL->scissor(titleBarBox);
+        } else {
+            if (TR.width > MAXWIDTH)
+                g_pHyprOpenGL->scissor(CROP);
+
+            g_pHyprOpenGL->renderTexture(m_pTextTex, titleBox.round(), {.a = a});
+
+            if (TR.width > MAXWIDTH)
+                g_pHyprOpenGL->scissor(titleBarBox);
+        }
     }
 
-    g_pHyprOpenGL->renderTexture(m_pButtonsTex, textBox, {.a = a});
+    {
+        CScopedBarStat buttonsStat(BAR_STAT_BUTTONS);
+
+        // buttons sit at a fixed distance from their edge, a resize only needs a new raster if fewer or more of them fit
+        const bool BUTTONSRESIZED = RESIZED &&
+            (RASTERSCALE != m_fButtonsRasterScale || getVisibleButtonCount(PBARBUTTONPADDING, PBARPADDING, RASTERBUF, RASTERSCALE) != m_iRasterVisibleButtons);
+
+        if (m_bButtonsDirty || BUTTONSRESIZED || m_pButtonsTex->m_texID == 0) {
+            renderBarButtons(RASTERBUF, RASTERSCALE);
+            m_bButtonsDirty = false;
+        }
+
+        const auto RATIO      = pMonitor->m_scale / m_fButtonsRasterScale;
+        const auto BUTTONSW   = m_pButtonsTex->m_size.x * RATIO;
+        CBox       buttonsBox = {BUTTONSRIGHT ? textBox.x + textBox.w - BUTTONSW : textBox.x, textBox.y, BUTTONSW, m_pButtonsTex->m_size.y * RATIO};
+
+        g_pHyprOpenGL->renderTexture(m_pButtonsTex, buttonsBox.round(), {.a = a});
+    }
 
     g_pHyprOpenGL->scissor(nullptr);
 
     renderBarButtonsText(&textBox, pMonitor->m_scale, a);
 
     m_bWindowSizeChanged = false;
-    m_bTitleColorChanged = false;
-
-    // dynamic updates change the extents
-    if (m_iLastHeight != **PHEIGHT) {
-        g_pLayoutManager->getCurrentLayout()->recalculateWindow(PWINDOW);
-        m_iLastHeight = **PHEIGHT;
-    }
+    m_bTitleDirty = false;
 }
 
 eDecorationType CHyprBar::getDecorationType() {
@@ -739,37 +998,98 @@ CBox CHyprBar::assignedBoxGlobal() {
     if (!validMapped(m_pWindow))
         return {};
 
+    // laying the window out again ends in a positioning reply, but a drag moves it between frames without one
+    const auto POSITION = m_pWindow->m_realPosition->value();
+    const auto SIZE     = m_pWindow->m_realSize->value();
+
+    if (m_boxCache.frame == g_pGlobalState->frame && m_boxCache.generation == m_iGeometryGeneration && m_boxCache.position == POSITION && m_boxCache.size == SIZE)
+        return m_boxCache.box;
+
+    m_boxCache.frame      = g_pGlobalState->frame;
+    m_boxCache.generation = m_iGeometryGeneration;
+    m_boxCache.position   = POSITION;
+    m_boxCache.size       = SIZE;
+
     CBox box = m_bAssignedBox;
     box.translate(g_pDecorationPositioner->getEdgeDefinedPoint(DECORATION_EDGE_TOP, m_pWindow.lock()));
 
     const auto PWORKSPACE      = m_pWindow->m_workspace;
     const auto WORKSPACEOFFSET = PWORKSPACE && !m_pWindow->m_pinned ? PWORKSPACE->m_renderOffset->value() : Vector2D();
 
-    return box.translate(WORKSPACEOFFSET);
+    m_boxCache.box = box.translate(WORKSPACEOFFSET);
+
+    return m_boxCache.box;
+}
+
+const std::vector<SHyprButton>& CHyprBar::getButtons() {
+    return m_pRuleButtons ? m_pRuleButtons->buttons : g_pGlobalState->buttons;
+}
+
+float CHyprBar::getButtonsWidth() {
+    if (m_pRuleButtons)
+        return m_pRuleButtons->buttonsWidth;
+
+    float width = 0;
+    for (const auto& b : g_pGlobalState->buttons) {
+        width += b.size;
+    }
+
+    return width;
 }
 
 PHLWINDOW CHyprBar::getOwner() {
     return m_pWindow.lock();
 }
 
-void CHyprBar::updateRules() {
+uint8_t CHyprBar::updateRules() {
+    TRACE_ZONE("CHyprBar::updateRules");
+
     const auto PWINDOW              = m_pWindow.lock();
     auto       rules                = PWINDOW->m_matchedRules;
     auto       prevHidden           = m_hidden;
+    auto       prevForcedBarColor   = m_bForcedBarColor;
     auto       prevForcedTitleColor = m_bForcedTitleColor;
 
     m_bForcedBarColor   = std::nullopt;
     m_bForcedTitleColor = std::nullopt;
     m_hidden            = false;
 
+    // button rules are collected and applied as one set, see internButtonSet
+    std::vector<std::string> buttonRules;
+
     for (auto& r : rules) {
-        applyRule(r);
+        // hyprbars_button is how the rule used to be documented
+        if (r->m_rule.starts_with("plugin:hyprbars:hyprbars-button") || r->m_rule.starts_with("plugin:hyprbars:hyprbars_button"))
+            buttonRules.emplace_back(r->m_rule.substr(r->m_rule.find_first_of(' ') + 1));
+        else
+            applyRule(r);
+    }
+
+    const auto PREVBUTTONS = m_pRuleButtons;
+    m_pRuleButtons         = buttonRules.empty() ? SP<const SButtonSet>{} : internButtonSet(buttonRules);
+
+    uint8_t diff = BAR_RULE_DIFF_NONE;
+
+    if (PREVBUTTONS != m_pRuleButtons) {
+        m_bButtonsDirty = true;
+        // title layout depends on the width taken by the buttons
+        m_bTitleDirty = true;
+        diff |= BAR_RULE_DIFF_BUTTONS;
     }
 
     if (prevHidden != m_hidden)
-        g_pDecorationPositioner->repositionDeco(this);
-    if (prevForcedTitleColor != m_bForcedTitleColor)
-        m_bTitleColorChanged = true;
+        diff |= BAR_RULE_DIFF_GEOMETRY;
+
+    if (prevForcedTitleColor != m_bForcedTitleColor) {
+        m_bTitleDirty = true;
+        diff |= BAR_RULE_DIFF_COLORS;
+    }
+
+    // the bar color is animated in renderPass, it only needs a repaint to pick up the new goal
+    if (prevForcedBarColor != m_bForcedBarColor)
+        diff |= BAR_RULE_DIFF_COLORS;
+
+    return diff;
 }
 
 void CHyprBar::applyRule(const SP<CWindowRule>& r) {
@@ -788,23 +1108,19 @@ void CHyprBar::damageOnButtonHover() {
     static auto* const PBARBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
     static auto* const PHEIGHT           = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_height")->getDataStaticPtr();
     static auto* const PALIGNBUTTONS     = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
-    const bool         BUTTONSRIGHT      = std::string{*PALIGNBUTTONS} != "left";
-
-    float              offset = **PBARPADDING;
 
     const auto         COORDS = cursorRelativeToBar();
 
-    for (auto& b : g_pGlobalState->buttons) {
-        const auto BARBUF     = Vector2D{(int)assignedBoxGlobal().w, **PHEIGHT};
-        Vector2D   currentPos = Vector2D{(BUTTONSRIGHT ? BARBUF.x - **PBARBUTTONPADDING - b.size - offset : offset), (BARBUF.y - b.size) / 2.0}.floor();
-
-        bool       hover = VECINRECT(COORDS, currentPos.x, currentPos.y, currentPos.x + b.size + **PBARBUTTONPADDING, currentPos.y + b.size);
-
-        if (hover != m_bButtonHovered) {
-            m_bButtonHovered = hover;
-            damageEntire();
-        }
-
-        offset += **PBARBUTTONPADDING + b.size;
+    const auto         GEOMETRY = BarLayout::SGeometry{
+        .barWidth      = assignedBoxGlobal().w,
+        .barHeight     = (double)**PHEIGHT,
+        .barPadding    = (double)**PBARPADDING,
+        .buttonPadding = (double)**PBARBUTTONPADDING,
+        .buttonsRight  = std::string{*PALIGNBUTTONS} != "left",
+    };
+
+    if (m_input.hoverChanged(GEOMETRY, getButtons(), {COORDS.x, COORDS.y})) {
+        damageEntire();
+        g_pBarStats->onHoverDamage();
     }
 }
@@ -9,12 +9,25 @@
 #include <hyprland/src/desktop/WindowRule.hpp>
 #include <hyprland/src/helpers/AnimatedVariable.hpp>
 #include <hyprland/src/helpers/time/Time.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopTimer.hpp>
 #include "globals.hpp"
+#include "BarInput.hpp"
+#include "BarRaster.hpp"
+#include "GlyphAtlas.hpp"
 
 #define private public
 #include <hyprland/src/managers/input/InputManager.hpp>
 #undef private
 
+// what changed in a bar after its window rules were re-evaluated, or the config was reloaded
+enum eBarRuleDiff : uint8_t {
+    BAR_RULE_DIFF_NONE     = 0,
+    BAR_RULE_DIFF_GEOMETRY = (1 << 0), // extents changed, needs a reposition
+    BAR_RULE_DIFF_COLORS   = (1 << 1), // bar / title color changed, needs a repaint
+    BAR_RULE_DIFF_BUTTONS  = (1 << 2), // button set changed, needs a button re-raster
+    BAR_RULE_DIFF_TITLE    = (1 << 3), // title looks different, needs a title re-raster
+};
+
 class CHyprBar : public IHyprWindowDecoration {
   public:
     CHyprBar(PHLWINDOW);
@@ -42,11 +55,31 @@ class CHyprBar : public IHyprWindowDecoration {
 
     PHLWINDOW                          getOwner();
 
-    void                               updateRules();
+    uint8_t                            updateRules();
     void                               applyRule(const SP<CWindowRule>&);
 
     WP<CHyprBar>                       m_self;
 
+    // moves the window to the latest touch drag position, once per frame
+    void                               applyTouchDrag();
+
+    // marks what the diff (eBarRuleDiff) makes outdated. Geometry changes only schedule a recalc of the
+    // monitor, so a config reload relayouts every monitor once however many bars it touches.
+    void                               invalidate(uint8_t diff);
+
+    // from the plugin wide activeWindow / windowTitle events
+    void                               setFocused(bool focused);
+    void                               onTitleChanged();
+
+    // input, from the plugin wide callbacks. Those only pass events on to the bars they can concern, see main.cpp
+    bool                               inputIsValid();
+    void                               onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e);
+    void                               onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e);
+    void                               onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e);
+    void                               onMouseMove(Vector2D coords);
+    void                               onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e);
+    void                               damageOnButtonHover();
+
   private:
     SBoxExtents               m_seExtents;
 
@@ -59,62 +92,101 @@ class CHyprBar : public IHyprWindowDecoration {
 
     bool                      m_bWindowSizeChanged = false;
     bool                      m_hidden             = false;
-    bool                      m_bTitleColorChanged = false;
-    bool                      m_bButtonHovered     = false;
-    bool                      m_bLastEnabledState  = false;
+    bool                      m_bTitleDirty        = false;
+    bool                      m_bTitleChanged      = false; // m_szLastTitle is outdated, re-render when the rate limit allows
     bool                      m_bWindowHasFocus    = false;
     std::optional<CHyprColor> m_bForcedBarColor;
     std::optional<CHyprColor> m_bForcedTitleColor;
-
-    Time::steady_tp           m_lastMouseDown = Time::steadyNow();
+    SP<const SButtonSet>      m_pRuleButtons;
+
+    Time::steady_tp           m_lastDrawn = Time::steadyNow();
+    Time::steady_tp           m_lastTitleRender;
+    SP<CEventLoopTimer>       m_pTitleTimer;  // trailing edge of the title refresh rate limit
+    SP<CEventLoopTimer>       m_pResizeTimer; // re-renders once a resize or animation settles
+
+    // what the title and button textures were rasterized for, so a resize can move them around instead
+    struct STitleRaster {
+        BarRaster::STitle title;
+        int               maxWidth     = 0;
+        int               width        = 0; // laid out text size
+        int               height       = 0;
+        int               naturalWidth = 0;
+        bool              ellipsized   = false;
+        Vector2D          rasterPos; // texture position relative to the layout origin
+        float             scale = 1;
+
+        // text_engine = atlas draws these instead of the texture, for as long as the atlas epoch matches
+        std::vector<BarRaster::SGlyphQuad> glyphs;
+        uint64_t                           glyphsEpoch = 0;
+    } m_titleRaster;
+    size_t m_iRasterVisibleButtons = 0;
+    float  m_fButtonsRasterScale   = 1;
+
+    // the rasters above for the other monitor scales the bar was drawn at. A window spanning monitors of
+    // different scales swaps them in and out per monitor instead of re-rasterizing, see useScale
+    struct SScaleVariant {
+        float           monitorScale = 0;
+        SP<CTexture>    textTex;
+        SP<CTexture>    buttonsTex;
+        STitleRaster    titleRaster;
+        size_t          rasterVisibleButtons = 0;
+        float           buttonsRasterScale   = 1;
+        bool            titleDirty           = true;
+        bool            buttonsDirty         = true;
+        bool            sizeChanged          = false;
+        Time::steady_tp lastDrawn;
+    };
+    float                      m_fMonitorScale = 0; // what the rasters in use are for, 0 before the first draw
+    std::vector<SScaleVariant> m_otherScales;
 
     PHLANIMVAR<CHyprColor>    m_cRealBarColor;
 
     Vector2D                  cursorRelativeToBar();
 
     void                      renderPass(PHLMONITOR, float const& a);
+    // completely covered by an opaque window on the monitor being rendered, see SOccluder
+    bool                      occluded(PHLMONITOR pMonitor);
+    void                      useScale(float monitorScale);
     void                      renderBarTitle(const Vector2D& bufferSize, const float scale);
+    bool                      titleRefreshDue();
+    bool                      titleLayoutChanged(const Vector2D& bufferSize, const float scale);
+    void                      scheduleSettledRaster();
     void                      renderText(SP<CTexture> out, const std::string& text, const CHyprColor& color, const Vector2D& bufferSize, const float scale, const int fontSize);
     void                      renderBarButtons(const Vector2D& bufferSize, const float scale);
     void                      renderBarButtonsText(CBox* barBox, const float scale, const float a);
-    void                      damageOnButtonHover();
-
-    bool                      inputIsValid();
-    void                      onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e);
-    void                      onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e);
-    void                      onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e);
-    void                      onMouseMove(Vector2D coords);
-    void                      onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e);
 
     void                      handleDownEvent(SCallbackInfo& info, std::optional<ITouch::SDownEvent> touchEvent);
     void                      handleUpEvent(SCallbackInfo& info);
     void                      handleMovement();
-    bool doButtonPress(Hyprlang::INT* const* PBARPADDING, Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PHEIGHT, Vector2D COORDS, bool BUTTONSRIGHT);
+    void                      beginTouchDrag();
+    // dispatches what BarInput says ends a drag, see eDragEnd
+    void                      endDrag(uint8_t dragEnd);
 
+    // memoized per frame and window geometry, it's asked for by the render pass, damage and every hit test
     CBox assignedBoxGlobal();
 
-    SP<HOOK_CALLBACK_FN> m_pMouseButtonCallback;
-    SP<HOOK_CALLBACK_FN> m_pTouchDownCallback;
-    SP<HOOK_CALLBACK_FN> m_pTouchUpCallback;
-
-    SP<HOOK_CALLBACK_FN> m_pTouchMoveCallback;
-    SP<HOOK_CALLBACK_FN> m_pMouseMoveCallback;
+    struct SBoxCache {
+        CBox     box;
+        uint64_t frame      = 0;
+        uint64_t generation = 0;
+        Vector2D position; // of the window
+        Vector2D size;
+    } m_boxCache;
+    uint64_t    m_iGeometryGeneration = 1; // bumped on every positioning reply
 
-    std::string          m_szLastTitle;
+    std::string m_szLastTitle;
 
-    bool                 m_bDraggingThis  = false;
-    bool                 m_bTouchEv       = false;
-    bool                 m_bDragPending   = false;
-    bool                 m_bCancelledDown = false;
-    int                  m_touchId        = 0;
+    // drag, double click and hover state, shared with the input benchmark
+    BarInput::CInputState m_input;
 
     // store hover state for buttons as a bitfield
     unsigned int m_iButtonHoverState = 0;
 
-    // for dynamic updates
-    int    m_iLastHeight = 0;
+    const std::vector<SHyprButton>& getButtons();
+    float                           getButtonsWidth();
 
     size_t getVisibleButtonCount(Hyprlang::INT* const* PBARBUTTONPADDING, Hyprlang::INT* const* PBARPADDING, const Vector2D& bufferSize, const float scale);
 
     friend class CBarPassElement;
+    friend class CTextureResidency;
 };
@@ -0,0 +1,164 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <print>
+
+#ifdef __GLIBC__
+
+// interpose the allocator so we also see what cairo, Pango and fontconfig allocate
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void  __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> allocCount = 0;
+static std::atomic<uint64_t> allocBytes = 0;
+
+static void countAlloc(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C" {
+void* malloc(size_t size) noexcept {
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) noexcept {
+    countAlloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) noexcept {
+    countAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    countAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    countAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+    countAlloc(size);
+    *out = __libc_memalign(alignment, size);
+    return *out ? 0 : ENOMEM;
+}
+
+void free(void* ptr) noexcept {
+    __libc_free(ptr);
+}
+}
+
+Bench::SAllocStats Bench::allocStats() {
+    return {allocCount.load(std::memory_order_relaxed), allocBytes.load(std::memory_order_relaxed)};
+}
+
+#else
+
+Bench::SAllocStats Bench::allocStats() {
+    return {};
+}
+
+#endif
+
+void Bench::CSamples::reserve(size_t n) {
+    m_samples.reserve(n);
+}
+
+void Bench::CSamples::add(clock::duration d) {
+    m_samples.emplace_back(std::chrono::duration<double, std::micro>(d).count());
+    m_sorted = false;
+}
+
+double Bench::CSamples::percentileUs(double p) {
+    if (m_samples.empty())
+        return 0;
+
+    if (!m_sorted) {
+        std::ranges::sort(m_samples);
+        m_sorted = true;
+    }
+
+    const size_t IDX = std::min(m_samples.size() - 1, (size_t)(p / 100.0 * (m_samples.size() - 1) + 0.5));
+    return m_samples[IDX];
+}
+
+double Bench::CSamples::meanUs() {
+    if (m_samples.empty())
+        return 0;
+
+    return std::accumulate(m_samples.begin(), m_samples.end(), 0.0) / m_samples.size();
+}
+
+size_t Bench::CSamples::size() const {
+    return m_samples.size();
+}
+
+Bench::SOptions Bench::parseOptions(int argc, char** argv, const char* usage) {
+    SOptions opts;
+
+    for (int i = 1; i < argc; ++i) {
+        if ((!strcmp(argv[i], "-n") || !strcmp(argv[i], "--iterations")) && i + 1 < argc)
+            opts.iterations = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+        else if (!strcmp(argv[i], "--csv"))
+            opts.csv = true;
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+            opts.replay = argv[++i];
+        else {
+            std::println(stderr, "usage: {} [-n|--iterations N] [--csv] [--replay FILE]\n{}", argv[0], usage);
+            std::exit(!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help") ? 0 : 1);
+        }
+    }
+
+    return opts;
+}
+
+void Bench::printHeader(const SOptions& opts, const std::vector<std::string>& keyColumns, const std::vector<std::string>& extraColumns) {
+    std::vector<std::string> columns = keyColumns;
+    for (const auto& c : {"p50_us", "p90_us", "p99_us", "max_us", "mean_us"}) {
+        columns.emplace_back(c);
+    }
+    columns.insert(columns.end(), extraColumns.begin(), extraColumns.end());
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (opts.csv)
+            std::print("{}{}", i ? "," : "", columns[i]);
+        else
+            std::print("{:>14}", columns[i]);
+    }
+    std::println("");
+}
+
+void Bench::printRow(const SOptions& opts, const std::vector<std::string>& keys, CSamples& samples, const std::vector<double>& extra) {
+    std::vector<std::string> columns = keys;
+    for (const auto v : {samples.percentileUs(50), samples.percentileUs(90), samples.percentileUs(99), samples.percentileUs(100), samples.meanUs()}) {
+        columns.emplace_back(std::format("{:.2f}", v));
+    }
+    for (const auto v : extra) {
+        columns.emplace_back(std::format("{:.1f}", v));
+    }
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (opts.csv)
+            std::print("{}{}", i ? "," : "", columns[i]);
+        else
+            std::print("{:>14}", columns[i]);
+    }
+    std::println("");
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Shared helpers for the headless hyprbars benchmarks.
+namespace Bench {
+    using clock = std::chrono::steady_clock;
+
+    // process wide malloc counters, see Bench.cpp. Zero on libcs we can't interpose.
+    struct SAllocStats {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+    };
+
+    SAllocStats allocStats();
+
+    // collects one duration per measured operation
+    class CSamples {
+      public:
+        void   reserve(size_t n);
+        void   add(clock::duration d);
+
+        double percentileUs(double p);
+        double meanUs();
+        size_t size() const;
+
+      private:
+        std::vector<double> m_samples;
+        bool                m_sorted = false;
+    };
+
+    struct SOptions {
+        size_t      iterations = 200;
+        bool        csv        = false;
+        std::string replay; // recorded input for benchmarks that consume event streams
+    };
+
+    SOptions parseOptions(int argc, char** argv, const char* usage);
+
+    // prints a header once, then rows. Columns are the percentiles and per-op counters.
+    void printHeader(const SOptions& opts, const std::vector<std::string>& keyColumns, const std::vector<std::string>& extraColumns);
+    void printRow(const SOptions& opts, const std::vector<std::string>& keys, CSamples& samples, const std::vector<double>& extra);
+}
@@ -0,0 +1,449 @@
+// Synthetic input benchmark: mouse motion, clicks and touch streams routed to N stub bars like the plugin
+// routes them, with the hit testing, drag state and hover damage decisions of the same BarInput::CInputState.
+
+#include "Bench.hpp"
+#include "../BarInput.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <print>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr const char* USAGE = "Feeds mouse / touch event streams to 1..500 stub bars and reports per-event latency and damage / dispatch counts.\n"
+                              "--replay FILE reads the stream from FILE instead, one event per line:\n"
+                              "  motion X Y | down X Y | up X Y | touchdown ID NX NY | touchmove ID NX NY | touchup ID\n"
+                              "X Y are global pixels on a 2560x1440 monitor, NX NY are normalized touch coordinates.";
+
+constexpr double MONW = 2560, MONH = 1440;
+constexpr double BARHEIGHT = 15, BARPADDING = 7, BUTTONPADDING = 5;
+
+enum eEventType : uint8_t {
+    EVENT_MOTION = 0,
+    EVENT_DOWN,
+    EVENT_UP,
+    EVENT_TOUCH_DOWN,
+    EVENT_TOUCH_MOVE,
+    EVENT_TOUCH_UP,
+    EVENT_TYPE_COUNT,
+};
+
+constexpr const char* EVENTNAMES[] = {"motion", "down", "up", "touchdown", "touchmove", "touchup"};
+
+struct SEvent {
+    eEventType type = EVENT_MOTION;
+    double     x = 0, y = 0;
+    int        touchID = 0;
+};
+
+struct SStubButton {
+    float size = 10;
+};
+
+struct SCounters {
+    uint64_t damages    = 0;
+    uint64_t dispatches = 0;
+};
+
+// stands in for Hyprland's dispatcher table: string keyed lookup + string arguments, like the plugin's button actions use it
+static std::unordered_map<std::string, std::function<void(std::string)>> dispatchers;
+
+// the drag dispatchers, resolved once like the plugin does on load
+struct SStubDragDispatchers {
+    std::function<void(std::string)> mouse, setFloating, setTiled, pin;
+};
+
+static SStubDragDispatchers dragDispatchers;
+
+// stands in for the layout's moveActiveWindow and resizeActiveWindow
+static void moveWindow(double x, double y) {
+    volatile auto sum = x + y;
+    (void)sum;
+}
+
+// a 120Hz touchscreen on a 60Hz output, the plugin applies touch drags once per frame
+constexpr size_t TOUCH_MOVES_PER_FRAME = 2;
+
+class CStubBar;
+
+struct SStubState {
+    double                   cursorX = 0, cursorY = 0;
+    int                      focused     = -1;
+    int                      pressed     = -1; // the plugin's pressedBar
+    int                      hovered     = -1; // the plugin's hoveredBar
+    bool                     iconOnHover = false;
+    std::vector<SStubButton> buttons     = {{10}, {10}, {10}};
+    SCounters                counters;
+    std::vector<CStubBar*>   pendingTouchDrags;
+};
+
+// CHyprBar's input handlers, with the decisions left to the same BarInput::CInputState
+class CStubBar {
+  public:
+    CStubBar(SStubState* state, int id, double x, double y, double w, double h, bool visible) : m_state(state), m_id(id), m_x(x), m_y(y), m_w(w), m_h(h), m_visible(visible) {
+        ;
+    }
+
+    void onMouseButton(bool pressed) {
+        if (!m_visible)
+            return;
+
+        if (!pressed) {
+            handleUpEvent();
+            return;
+        }
+
+        handleDownEvent(std::nullopt);
+    }
+
+    void onTouchDown(const SEvent& e) {
+        if (!m_visible || e.touchID != 0)
+            return;
+
+        handleDownEvent(e);
+    }
+
+    void onTouchUp(const SEvent& e) {
+        if (!m_input.tracksTouch(e.touchID))
+            return;
+
+        applyTouchDrag();
+
+        handleUpEvent();
+    }
+
+    void onMouseMove() {
+        if (m_input.startMouseDrag())
+            dispatch(dragDispatchers.mouse, "1movewindow");
+    }
+
+    void onTouchMove(const SEvent& e) {
+        if (!m_input.tracksTouch(e.touchID))
+            return;
+
+        if (m_input.moveTouch({e.x * MONW, e.y * MONH}))
+            m_state->pendingTouchDrags.emplace_back(this);
+    }
+
+    // the plugin's preRender
+    void applyTouchDrag() {
+        const auto COORDS = m_input.takeTouchMove();
+
+        if (!COORDS)
+            return;
+
+        if (m_input.beginTouchDrag()) {
+            // the plugin floats the window at the drag size, so the resize only happens if it was floating already
+            dispatch(dragDispatchers.setFloating, "activewindow");
+            dispatch(dragDispatchers.pin, "activewindow");
+        }
+
+        moveWindow((int)(COORDS->x - m_w / 2), (int)COORDS->y);
+    }
+
+    void damageOnButtonHover() {
+        if (m_input.hoverChanged(geometry(), m_state->buttons, {m_state->cursorX - m_x, m_state->cursorY - m_y}))
+            damageEntire();
+    }
+
+    // the window box, what finding the window under the cursor goes by
+    bool contains(double x, double y) const {
+        return m_visible && x >= m_x && x < m_x + m_w && y >= m_y && y < m_y + m_h;
+    }
+
+  private:
+    SStubState*           m_state = nullptr;
+    int                   m_id    = 0;
+    double                m_x = 0, m_y = 0, m_w = 0, m_h = 0; // window box, the bar is the top BARHEIGHT px
+    bool                  m_visible = true;
+
+    BarInput::CInputState m_input;
+
+    void dispatch(const std::string& name, const std::string& arg) {
+        m_state->counters.dispatches++;
+        dispatchers[name](arg);
+    }
+
+    void dispatch(const std::function<void(std::string)>& fn, const char* arg) {
+        m_state->counters.dispatches++;
+        fn(arg);
+    }
+
+    void damageEntire() {
+        m_state->counters.damages++;
+    }
+
+    BarLayout::SGeometry geometry() const {
+        return {.barWidth = m_w, .barHeight = BARHEIGHT, .barPadding = BARPADDING, .buttonPadding = BUTTONPADDING, .buttonsRight = true};
+    }
+
+    void handleDownEvent(std::optional<SEvent> touch) {
+        const double X = (touch ? touch->x * MONW : m_state->cursorX) - m_x;
+        const double Y = (touch ? touch->y * MONH : m_state->cursorY) - m_y;
+
+        // on_double_click is unset by default
+        const auto PRESS =
+            m_input.press(geometry(), m_state->buttons, {X, Y}, touch ? std::optional<int>{touch->touchID} : std::nullopt, false, BarInput::CInputState::clock::now());
+
+        if (PRESS.type == BarInput::PRESS_OUTSIDE) {
+            endDrag(PRESS.dragEnd);
+            return;
+        }
+
+        m_state->focused = m_id;
+        m_state->pressed = m_id;
+
+        if (PRESS.type == BarInput::PRESS_BUTTON)
+            dispatch("killactive", "");
+    }
+
+    void handleUpEvent() {
+        if (m_state->focused != m_id)
+            return;
+
+        endDrag(m_input.release().dragEnd);
+    }
+
+    void endDrag(uint8_t dragEnd) {
+        if (dragEnd == BarInput::DRAG_END_NONE)
+            return;
+
+        dispatch(dragDispatchers.mouse, "0movewindow");
+        if (dragEnd & BarInput::DRAG_END_TOUCH)
+            dispatch(dragDispatchers.setTiled, "activewindow");
+    }
+};
+
+// like the compositor finding the window under the cursor, the bars are laid out in window order
+static int barAt(const std::vector<CStubBar>& bars, double x, double y) {
+    for (size_t i = 0; i < bars.size(); ++i) {
+        if (bars[i].contains(x, y))
+            return i;
+    }
+
+    return -1;
+}
+
+// the plugin's routing, see pressTargets in main.cpp: the focused bar, then the one under the cursor
+static std::array<int, 2> pressTargets(const std::vector<CStubBar>& bars, const SStubState& state) {
+    const int ATCURSOR = barAt(bars, state.cursorX, state.cursorY);
+    return {state.focused, ATCURSOR == state.focused ? -1 : ATCURSOR};
+}
+
+// tiles `count` bars in grids of 16 windows per workspace, only the first workspace is visible
+static std::vector<CStubBar> makeBars(SStubState* state, size_t count) {
+    constexpr size_t PERWORKSPACE = 16;
+    constexpr size_t COLS = 4, ROWS = 4;
+
+    std::vector<CStubBar> bars;
+    bars.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t SLOT = i % PERWORKSPACE;
+        const double W = MONW / COLS, H = MONH / ROWS;
+        bars.emplace_back(state, (int)i, (SLOT % COLS) * W, (SLOT / COLS) * H, W, H, i < PERWORKSPACE);
+    }
+
+    return bars;
+}
+
+// cursor wandering over the monitor with regular trips to the bars and their buttons, a click every
+// 40 events and a touch drag every 500
+static std::vector<SEvent> syntheticStream(size_t count) {
+    std::mt19937                           rng(0xB4A5);
+    std::uniform_real_distribution<double> step(-12, 12);
+    std::uniform_int_distribution<int>     slot(0, 15);
+
+    std::vector<SEvent>                    events;
+    events.reserve(count);
+
+    double x = MONW / 2, y = MONH / 2;
+
+    while (events.size() < count) {
+        const size_t I = events.size();
+
+        if (I % 500 == 0) {
+            // touch drag starting on the bar of the window under the cursor, a touch only concerns that one and the focused one
+            const int    S  = (int)(x / (MONW / 4)) + 4 * (int)(y / (MONH / 4));
+            const double TX = ((S % 4) * MONW / 4 + MONW / 8) / MONW, TY = ((S / 4) * MONH / 4 + 5) / MONH;
+            events.push_back({EVENT_TOUCH_DOWN, TX, TY, 0});
+            for (int m = 1; m <= 20; ++m) {
+                events.push_back({EVENT_TOUCH_MOVE, TX + m * 0.002, TY + m * 0.002, 0});
+            }
+            events.push_back({EVENT_TOUCH_UP, 0, 0, 0});
+            continue;
+        }
+
+        if (I % 40 == 0) {
+            // jump onto the buttons of a random bar and click
+            const int S = slot(rng);
+            x           = (S % 4 + 1) * MONW / 4 - BARPADDING - 12;
+            y           = (S / 4) * MONH / 4 + BARHEIGHT / 2;
+            events.push_back({EVENT_MOTION, x, y, 0});
+            events.push_back({EVENT_DOWN, x, y, 0});
+            events.push_back({EVENT_UP, x, y, 0});
+            continue;
+        }
+
+        x = std::clamp(x + step(rng), 0.0, MONW - 1);
+        y = std::clamp(y + step(rng), 0.0, MONH - 1);
+        events.push_back({EVENT_MOTION, x, y, 0});
+    }
+
+    return events;
+}
+
+static std::vector<SEvent> replayStream(const std::string& path) {
+    std::ifstream       file(path);
+    std::vector<SEvent> events;
+
+    if (!file.good()) {
+        std::println(stderr, "failed to open {}", path);
+        std::exit(1);
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        std::string        type;
+        SEvent             e;
+
+        if (!(ss >> type) || type.starts_with('#'))
+            continue;
+
+        if (type == "motion" || type == "down" || type == "up") {
+            e.type = type == "motion" ? EVENT_MOTION : type == "down" ? EVENT_DOWN : EVENT_UP;
+            ss >> e.x >> e.y;
+        } else if (type == "touchdown" || type == "touchmove") {
+            e.type = type == "touchdown" ? EVENT_TOUCH_DOWN : EVENT_TOUCH_MOVE;
+            ss >> e.touchID >> e.x >> e.y;
+        } else if (type == "touchup") {
+            e.type = EVENT_TOUCH_UP;
+            ss >> e.touchID;
+        } else {
+            std::println(stderr, "unknown event \"{}\" in {}", type, path);
+            std::exit(1);
+        }
+
+        events.emplace_back(e);
+    }
+
+    return events;
+}
+
+int main(int argc, char** argv) {
+    const auto OPTS = Bench::parseOptions(argc, argv, USAGE);
+
+    for (const auto& name : {"mouse", "setfloating", "resizewindowpixel", "pin", "settiled", "killactive"}) {
+        dispatchers[name] = [](std::string arg) {
+            volatile auto len = arg.size();
+            (void)len;
+        };
+    }
+
+    dragDispatchers = {
+        .mouse       = dispatchers["mouse"],
+        .setFloating = dispatchers["setfloating"],
+        .setTiled    = dispatchers["settiled"],
+        .pin         = dispatchers["pin"],
+    };
+
+    const auto EVENTS = OPTS.replay.empty() ? syntheticStream(OPTS.iterations * 50) : replayStream(OPTS.replay);
+
+    Bench::printHeader(OPTS, {"bars", "hover_icons", "event", "count"}, {"damages_ev", "dispatch_ev"});
+
+    for (const size_t BARCOUNT : {1, 10, 50, 100, 250, 500}) {
+        for (const bool ICONONHOVER : {false, true}) {
+            SStubState state;
+            state.iconOnHover = ICONONHOVER;
+
+            auto            bars = makeBars(&state, BARCOUNT);
+
+            Bench::CSamples samples[EVENT_TYPE_COUNT];
+            SCounters       perType[EVENT_TYPE_COUNT];
+            size_t          touchMoves = 0;
+
+            for (const auto& e : EVENTS) {
+                const auto BEFORE = state.counters;
+                const auto BEGIN  = Bench::clock::now();
+
+                // routed like the plugin's callbacks do it, an event visits at most two bars
+                switch (e.type) {
+                    case EVENT_MOTION: {
+                        state.cursorX = e.x;
+                        state.cursorY = e.y;
+
+                        if (state.iconOnHover) {
+                            const int HOVERED = barAt(bars, state.cursorX, state.cursorY);
+
+                            if (state.hovered >= 0 && state.hovered != HOVERED)
+                                bars[state.hovered].damageOnButtonHover();
+
+                            if (HOVERED >= 0)
+                                bars[HOVERED].damageOnButtonHover();
+
+                            state.hovered = HOVERED;
+                        }
+
+                        if (state.pressed >= 0)
+                            bars[state.pressed].onMouseMove();
+                        break;
+                    }
+                    case EVENT_DOWN:
+                    case EVENT_UP:
+                        for (const int b : pressTargets(bars, state)) {
+                            if (b >= 0)
+                                bars[b].onMouseButton(e.type == EVENT_DOWN);
+                        }
+                        break;
+                    case EVENT_TOUCH_DOWN:
+                        for (const int b : pressTargets(bars, state)) {
+                            if (b >= 0)
+                                bars[b].onTouchDown(e);
+                        }
+                        break;
+                    case EVENT_TOUCH_MOVE:
+                        if (state.pressed >= 0)
+                            bars[state.pressed].onTouchMove(e);
+
+                        // the frame's share of the work goes to the event that ends it
+                        if (++touchMoves % TOUCH_MOVES_PER_FRAME == 0) {
+                            for (const auto b : state.pendingTouchDrags) {
+                                b->applyTouchDrag();
+                            }
+                            state.pendingTouchDrags.clear();
+                        }
+                        break;
+                    case EVENT_TOUCH_UP:
+                        if (state.pressed >= 0)
+                            bars[state.pressed].onTouchUp(e);
+                        break;
+                    default: break;
+                }
+
+                samples[e.type].add(Bench::clock::now() - BEGIN);
+                perType[e.type].damages += state.counters.damages - BEFORE.damages;
+                perType[e.type].dispatches += state.counters.dispatches - BEFORE.dispatches;
+            }
+
+            for (size_t t = 0; t < EVENT_TYPE_COUNT; ++t) {
+                if (!samples[t].size())
+                    continue;
+
+                const double N = samples[t].size();
+                Bench::printRow(OPTS, {std::to_string(BARCOUNT), ICONONHOVER ? "yes" : "no", EVENTNAMES[t], std::to_string(samples[t].size())}, samples[t],
+                                {perType[t].damages / N, perType[t].dispatches / N});
+            }
+        }
+    }
+
+    return 0;
+}
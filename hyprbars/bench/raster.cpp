@@ -0,0 +1,225 @@
+// Headless benchmark of the bar rasterization: titles, button circles and button icons,
+// driven through BarRaster exactly like CHyprBar does it, minus the GL upload. Plus the
+// CPU side of text_engine = atlas, laying titles out against the glyph atlas.
+
+#include "Bench.hpp"
+#include "../BarRaster.hpp"
+#include "../GlyphAtlas.hpp"
+
+#include <cairo/cairo.h>
+
+#include <print>
+#include <string>
+#include <vector>
+
+constexpr const char* USAGE = "Rasterizes bar titles, buttons and icons with cairo/Pango and reports per-raster latency, bytes and allocations.";
+
+static std::string makeTitle(size_t len) {
+    // mix of ascii, wide and combining characters, like real titles tend to be
+    static const std::string PATTERN = "nvim ~/src/hyprbars/barDeco.cpp — Ünïcødé 終端 · ";
+
+    std::string              out;
+    while (out.size() < len) {
+        out += PATTERN;
+    }
+
+    // cut on a codepoint boundary
+    size_t cut = len;
+    while (cut > 0 && (out[cut] & 0xC0) == 0x80) {
+        --cut;
+    }
+
+    return out.substr(0, cut);
+}
+
+// runs fn once per iteration on a surface from a pool, the same way the plugin does per raster
+template <typename F>
+static void measure(const Bench::SOptions& opts, const std::vector<std::string>& keys, const int width, const int height, F&& fn) {
+    static BarRaster::CSurfacePool pool;
+
+    Bench::CSamples                samples;
+    samples.reserve(opts.iterations);
+
+    // warm up font caches so the first config doesn't pay for fontconfig, and the pool so it has a surface that fits
+    for (size_t i = 0; i < 3; ++i) {
+        const auto SURFACE = pool.acquire(width, height);
+        fn(SURFACE->cairo);
+        pool.release(SURFACE);
+    }
+
+    const auto ALLOCSBEFORE = Bench::allocStats();
+
+    for (size_t i = 0; i < opts.iterations; ++i) {
+        const auto BEGIN = Bench::clock::now();
+
+        const auto SURFACE = pool.acquire(width, height);
+
+        fn(SURFACE->cairo);
+        cairo_surface_flush(SURFACE->surface);
+
+        pool.release(SURFACE);
+
+        samples.add(Bench::clock::now() - BEGIN);
+    }
+
+    const auto ALLOCSAFTER = Bench::allocStats();
+    const auto N           = (double)opts.iterations;
+
+    Bench::printRow(opts, keys, samples,
+                    {
+                        (double)width * height * 4 / 1024.0,
+                        (ALLOCSAFTER.count - ALLOCSBEFORE.count) / N,
+                        (ALLOCSAFTER.bytes - ALLOCSBEFORE.bytes) / N / 1024.0,
+                    });
+}
+
+// runs fn once per iteration, for the work that doesn't draw into a surface. fn returns the first extra column.
+template <typename F>
+static void measureLayout(const Bench::SOptions& opts, const std::vector<std::string>& keys, F&& fn) {
+    Bench::CSamples samples;
+    samples.reserve(opts.iterations);
+
+    // warm up, the glyphs are in the atlas after the first run
+    double first = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        first = fn();
+    }
+
+    const auto ALLOCSBEFORE = Bench::allocStats();
+
+    for (size_t i = 0; i < opts.iterations; ++i) {
+        const auto BEGIN = Bench::clock::now();
+
+        fn();
+
+        samples.add(Bench::clock::now() - BEGIN);
+    }
+
+    const auto ALLOCSAFTER = Bench::allocStats();
+    const auto N           = (double)opts.iterations;
+
+    Bench::printRow(opts, keys, samples,
+                    {
+                        first,
+                        (ALLOCSAFTER.count - ALLOCSBEFORE.count) / N,
+                        (ALLOCSAFTER.bytes - ALLOCSBEFORE.bytes) / N / 1024.0,
+                    });
+}
+
+int main(int argc, char** argv) {
+    const auto                     OPTS = Bench::parseOptions(argc, argv, USAGE);
+
+    const std::vector<size_t>      TITLELENGTHS = {8, 32, 128, 512};
+    const std::vector<std::string> FONTS        = {"Sans", "Serif", "Monospace"};
+    const std::vector<double>      SCALES       = {1.0, 1.5, 2.0};
+    const std::vector<int>         BARWIDTHS    = {400, 1200, 2560};
+
+    constexpr int                  BARHEIGHT    = 15;
+    constexpr int                  TEXTSIZE     = 10;
+    constexpr int                  BARPADDING   = 7;
+    constexpr int                  BUTTONPAD    = 5;
+    constexpr double               BUTTONSIZE   = 10;
+    constexpr size_t               BUTTONCOUNT  = 3;
+
+    const std::vector<std::string> EXTRA = {"kb_raster", "allocs_op", "kb_alloc_op"};
+
+    std::println("# titles");
+    Bench::printHeader(OPTS, {"len", "font", "scale", "width"}, EXTRA);
+
+    for (const auto LEN : TITLELENGTHS) {
+        const auto TEXT = makeTitle(LEN);
+
+        for (const auto& font : FONTS) {
+            for (const auto SCALE : SCALES) {
+                for (const auto WIDTH : BARWIDTHS) {
+                    const int               W = WIDTH * SCALE, H = BARHEIGHT * SCALE;
+
+                    const BarRaster::STitle TITLE = {
+                        .text         = TEXT,
+                        .font         = font,
+                        .fontSize     = TEXTSIZE * SCALE,
+                        .color        = {1, 1, 1, 1},
+                        .alignLeft    = false,
+                        .buttonsRight = true,
+                        .barPadding   = BARPADDING * SCALE,
+                        .buttonsWidth = (BUTTONPAD * (BUTTONCOUNT + 1) + BUTTONSIZE * BUTTONCOUNT) * SCALE,
+                        .borderSize   = 2 * SCALE,
+                    };
+
+                    measure(OPTS, {std::to_string(LEN), font, std::format("{:.1f}", SCALE), std::to_string(WIDTH)}, W, H,
+                            [&](cairo_t* cr) { BarRaster::renderTitle(cr, W, H, TITLE); });
+                }
+            }
+        }
+    }
+
+    std::println("\n# atlas titles");
+    Bench::printHeader(OPTS, {"len", "font", "scale"}, {"glyphs", "allocs_op", "kb_alloc_op"});
+
+    BarRaster::CSurfacePool            layoutPool;
+    BarRaster::CGlyphAtlas             atlas;
+    std::vector<BarRaster::SGlyphQuad> quads;
+
+    for (const auto LEN : TITLELENGTHS) {
+        const auto TEXT = makeTitle(LEN);
+
+        for (const auto& font : FONTS) {
+            for (const auto SCALE : SCALES) {
+                const BarRaster::STitle TITLE = {
+                    .text         = TEXT,
+                    .font         = font,
+                    .fontSize     = TEXTSIZE * SCALE,
+                    .color        = {1, 1, 1, 1},
+                    .alignLeft    = false,
+                    .buttonsRight = true,
+                    .barPadding   = BARPADDING * SCALE,
+                    .buttonsWidth = (BUTTONPAD * (BUTTONCOUNT + 1) + BUTTONSIZE * BUTTONCOUNT) * SCALE,
+                    .borderSize   = 2 * SCALE,
+                };
+
+                const int MAXWIDTH = BarRaster::titleMaxWidth(1200 * SCALE, TITLE);
+
+                measureLayout(OPTS, {std::to_string(LEN), font, std::format("{:.1f}", SCALE)}, [&]() {
+                    const BarRaster::CTitleLayout LAYOUT(layoutPool.scratchContext(), TITLE, MAXWIDTH);
+                    atlas.layout(LAYOUT, quads);
+                    return (double)quads.size();
+                });
+            }
+        }
+    }
+
+    std::println("\n# buttons");
+    Bench::printHeader(OPTS, {"count", "scale", "width"}, EXTRA);
+
+    for (const size_t COUNT : {1, 3, 8}) {
+        for (const auto SCALE : SCALES) {
+            for (const auto WIDTH : BARWIDTHS) {
+                const int           W = WIDTH * SCALE, H = BARHEIGHT * SCALE;
+
+                BarRaster::SButtons buttons = {.barPadding = BARPADDING * SCALE, .buttonPadding = BUTTONPAD * SCALE, .right = true};
+                for (size_t i = 0; i < COUNT; ++i) {
+                    buttons.buttons.emplace_back(BarRaster::SButton{.size = BUTTONSIZE * SCALE, .color = {1, 0.25, 0.25, 1}});
+                }
+
+                measure(OPTS, {std::to_string(COUNT), std::format("{:.1f}", SCALE), std::to_string(WIDTH)}, W, H,
+                        [&](cairo_t* cr) { BarRaster::renderButtons(cr, W, H, buttons); });
+            }
+        }
+    }
+
+    std::println("\n# icons");
+    Bench::printHeader(OPTS, {"icon", "scale", "size"}, EXTRA);
+
+    for (const auto& icon : {"X", "󰖭", ""}) {
+        for (const auto SCALE : SCALES) {
+            for (const double SIZE : {10.0, 16.0, 24.0}) {
+                const int W = SIZE * SCALE, H = SIZE * SCALE;
+
+                measure(OPTS, {icon, std::format("{:.1f}", SCALE), std::format("{:.0f}", SIZE)}, W, H,
+                        [&](cairo_t* cr) { BarRaster::renderText(cr, W, H, icon, {0, 0, 0, 1}, (int)(SIZE * 0.62) * SCALE); });
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+// Throughput of the BGRA -> RGBA conversion used for GL uploads without GL_TEXTURE_SWIZZLE,
+// over bar sized buffers. tests/swizzle.cpp checks the kernels are correct.
+
+#include "Bench.hpp"
+#include "../Swizzle.hpp"
+
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <vector>
+
+constexpr const char* USAGE = "Converts bar sized BGRA buffers to RGBA and reports per-buffer latency and throughput, for the vectorized and the scalar kernel.";
+
+template <typename F>
+static void measure(const Bench::SOptions& opts, const std::vector<std::string>& keys, const size_t width, const size_t height, F&& fn) {
+    std::vector<uint8_t> buffer(width * height * 4, 0x7F);
+
+    Bench::CSamples      samples;
+    samples.reserve(opts.iterations);
+
+    for (size_t i = 0; i < opts.iterations; ++i) {
+        const auto BEGIN = Bench::clock::now();
+        fn(buffer.data(), width * 4, width, height);
+        samples.add(Bench::clock::now() - BEGIN);
+    }
+
+    const double MB = width * height * 4 / 1024.0 / 1024.0;
+    Bench::printRow(opts, keys, samples, {width * height * 4 / 1024.0, MB / (samples.meanUs() / 1000000.0)});
+}
+
+int main(int argc, char** argv) {
+    const auto OPTS = Bench::parseOptions(argc, argv, USAGE);
+
+    std::println("# kernel: {}", Swizzle::kernelName());
+    Bench::printHeader(OPTS, {"kernel", "scale", "width"}, {"kb_buffer", "mb_s"});
+
+    constexpr int BARHEIGHT = 15;
+
+    for (const double SCALE : {1.0, 1.5, 2.0}) {
+        for (const int WIDTH : {400, 1200, 2560}) {
+            const size_t W = WIDTH * SCALE, H = BARHEIGHT * SCALE;
+            const auto   KEYS = [&](const char* kernel) { return std::vector<std::string>{kernel, std::format("{:.1f}", SCALE), std::to_string(WIDTH)}; };
+
+            measure(OPTS, KEYS(Swizzle::kernelName()), W, H, [](uint8_t* buf, size_t stride, size_t w, size_t h) { Swizzle::bgraToRgba(buf, stride, buf, stride, w, h); });
+            measure(OPTS, KEYS("scalar"), W, H, [](uint8_t* buf, size_t stride, size_t w, size_t h) { Swizzle::bgraToRgbaScalar(buf, stride, buf, stride, w, h); });
+        }
+    }
+
+    return 0;
+}
@@ -2,24 +2,112 @@
 
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprland/src/render/Texture.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/managers/KeybindManager.hpp>
+
+#include <unordered_map>
+
+#include "BarRaster.hpp"
+#include "ScaledTextures.hpp"
 
 inline HANDLE PHANDLE = nullptr;
 
+// what a button or a double click on the bar runs. Parsed once from the config: a shell command becomes
+// {"exec", command}, "dispatch:<dispatcher> [arg]" calls the dispatcher in-process.
+struct SBarAction {
+    std::string dispatcher; // empty for nothing
+    std::string arg;
+};
+
 struct SHyprButton {
-    std::string  cmd     = "";
-    bool         userfg  = false;
-    CHyprColor   fgcol   = CHyprColor(0, 0, 0, 0);
-    CHyprColor   bgcol   = CHyprColor(0, 0, 0, 0);
-    float        size    = 10;
-    std::string  icon    = "";
-    SP<CTexture> iconTex = makeShared<CTexture>();
+    SBarAction          action;
+    bool                userfg       = false;
+    CHyprColor          fgcol        = CHyprColor(0, 0, 0, 0);
+    CHyprColor          bgcol        = CHyprColor(0, 0, 0, 0);
+    float               size         = 10;
+    std::string         icon         = "";
+    SP<CScaledTextures> iconTextures = makeShared<CScaledTextures>(); // per monitor scale
+};
+
+// buttons coming from window rules. Sets are immutable and interned by their definition,
+// so every bar matching the same rules shares one set and its icon textures.
+struct SButtonSet {
+    std::vector<SHyprButton> buttons;
+    float                    buttonsWidth = 0; // sum of the button sizes, unscaled
+};
+
+using SDispatcherFn = decltype(CKeybindManager::m_dispatchers)::mapped_type;
+
+// Hyprland dispatchers the drag code calls on every drag, resolved once on load
+struct SDragDispatchers {
+    SDispatcherFn mouse;
+    SDispatcherFn setFloating;
+    SDispatcherFn setTiled;
+    SDispatcherFn pin;
+};
+
+// the config values bars cache something for, compared on every config reload
+struct SBarSettings {
+    Hyprlang::INT enabled              = 1;
+    Hyprlang::INT height               = 15;
+    Hyprlang::INT precedenceOverBorder = 0;
+    Hyprlang::INT partOfWindow         = 1;
+    Hyprlang::INT barColor             = 0;
+    Hyprlang::INT blur                 = 0;
+    Hyprlang::INT titleEnabled         = 1;
+    Hyprlang::INT textColor            = 0;
+    Hyprlang::INT textSize             = 0;
+    std::string   textFont;
+    std::string   textAlign;
+    std::string   buttonsAlignment;
+    Hyprlang::INT padding             = 0;
+    Hyprlang::INT buttonPadding       = 0;
+    Hyprlang::INT inactiveButtonColor = 0;
+    std::string   textEngine;
+};
+
+// an opaque window on the monitor being rendered, bars it covers completely aren't drawn
+struct SOccluder {
+    PHLWINDOWREF window;
+    CBox         box;                // global, without the rounded corners
+    bool         fullscreen = false; // real fullscreen, covers floating windows as well. Maximized windows don't.
 };
 
 class CHyprBar;
+class CEventLoopTimer;
 
 struct SGlobalState {
-    std::vector<SHyprButton>  buttons;
-    std::vector<WP<CHyprBar>> bars;
+    std::vector<SHyprButton>                              buttons;
+    std::vector<SHyprButton>                              previousButtons; // during a config reload, the buttons from before it
+    bool                                                  reloading = false;
+    SBarSettings                                          settings;
+    std::vector<WP<CHyprBar>>                             bars;
+    std::unordered_map<std::string, WP<const SButtonSet>> buttonSets;
+
+    // windows on background workspaces that existed when the plugin was loaded, attached in batches
+    std::vector<PHLWINDOWREF> pendingWindows;
+    SP<CEventLoopTimer>       pendingTimer;
+
+    SBarAction                doubleClickAction;
+    std::string               doubleClickRaw; // on_double_click as doubleClickAction was parsed from
+    std::vector<WP<CHyprBar>> pendingTouchDrags; // applied in preRender
+    WP<CHyprBar>              focusedBar;
+    WP<CHyprBar>              pressedBar; // took the last press on its bar, gets the motion and touch up events after it
+    WP<CHyprBar>              hoveredBar; // for icon_on_hover, the bar the cursor was last over
+    uint64_t                  frame = 0; // bumped in preRender, for what's computed once per frame
+    SDragDispatchers          dispatchers;
+
+    // the floating and fullscreen windows, looked for again only after the events that change them. Of those,
+    // the ones covering something on the monitor being rendered, for the first bar drawn there each frame.
+    std::vector<PHLWINDOWREF> occluderWindows;
+    bool                      occluderWindowsDirty = true;
+    std::vector<SOccluder>    occluders;
+    uint64_t                  occludersFrame = 0;
+
+    // scratch surfaces for every raster, they're uploaded right away
+    BarRaster::CSurfacePool rasterSurfaces;
+    // the tightly packed RGBA copy GLES2 uploads go through, see uploadSurface
+    std::vector<uint8_t> uploadScratch;
 };
 
 inline UP<SGlobalState> g_pGlobalState;
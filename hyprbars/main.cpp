@@ -7,11 +7,19 @@
 #include <hyprland/src/desktop/Window.hpp>
 #include <hyprland/src/config/ConfigManager.hpp>
 #include <hyprland/src/render/Renderer.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopManager.hpp>
+#include <hyprland/src/managers/eventLoop/EventLoopTimer.hpp>
 
 #include <algorithm>
+#include <array>
 
 #include "barDeco.hpp"
+#include "ButtonSet.hpp"
+#include "GlyphRenderer.hpp"
+#include "Stats.hpp"
+#include "TextureResidency.hpp"
 #include "globals.hpp"
+#include "../common/Trace.hpp"
 
 // Do NOT change this function.
 APICALL EXPORT std::string PLUGIN_API_VERSION() {
@@ -29,10 +37,103 @@ static void onNewWindow(void* self, std::any data) {
         auto bar = makeUnique<CHyprBar>(PWINDOW);
         g_pGlobalState->bars.emplace_back(bar);
         bar->m_self = bar;
+
+        if (PWINDOW == g_pCompositor->m_lastWindow.lock())
+            g_pGlobalState->focusedBar = bar;
         HyprlandAPI::addWindowDecoration(PHANDLE, PWINDOW, std::move(bar));
     }
 }
 
+// windows have a handful of decorations, so this doesn't depend on the number of bars
+static CHyprBar* barForWindow(PHLWINDOW window) {
+    if (!window)
+        return nullptr;
+
+    for (const auto& d : window->m_windowDecorations) {
+        if (const auto BAR = dynamic_cast<CHyprBar*>(d.get()); BAR)
+            return BAR;
+    }
+
+    return nullptr;
+}
+
+static void onActiveWindow(PHLWINDOW window) {
+    if (const auto PREV = g_pGlobalState->focusedBar.lock())
+        PREV->setFocused(false);
+
+    const auto BAR = barForWindow(window);
+
+    if (BAR)
+        BAR->setFocused(true);
+
+    g_pGlobalState->focusedBar = BAR ? BAR->m_self : WP<CHyprBar>{};
+}
+
+static void onWindowTitle(PHLWINDOW window) {
+    if (const auto BAR = barForWindow(window))
+        BAR->onTitleChanged();
+}
+
+// Bars have no input callbacks of their own, each event is passed on to the few bars it can concern.
+// A press or a release can only concern the focused bar and the one under the cursor, focused first so it
+// can end its drag before the other one takes focus.
+static std::array<WP<CHyprBar>, 2> pressTargets() {
+    const auto WINDOWATCURSOR = g_pCompositor->vectorToWindowUnified(g_pInputManager->getMouseCoordsInternal(), RESERVED_EXTENTS | INPUT_EXTENTS | ALLOW_FLOATING);
+    const auto ATCURSOR       = barForWindow(WINDOWATCURSOR);
+    const auto FOCUSED        = g_pGlobalState->focusedBar;
+
+    if (!ATCURSOR || ATCURSOR == FOCUSED.get())
+        return {FOCUSED, {}};
+
+    return {FOCUSED, ATCURSOR->m_self};
+}
+
+static void onMouseButton(SCallbackInfo& info, IPointer::SButtonEvent e) {
+    for (const auto& b : pressTargets()) {
+        if (const auto BAR = b.lock())
+            BAR->onMouseButton(info, e);
+    }
+}
+
+static void onTouchDown(SCallbackInfo& info, ITouch::SDownEvent e) {
+    for (const auto& b : pressTargets()) {
+        if (const auto BAR = b.lock())
+            BAR->onTouchDown(info, e);
+    }
+}
+
+// motion and lifting a finger only do something for the bar a drag may have started on
+static void onTouchUp(SCallbackInfo& info, ITouch::SUpEvent e) {
+    if (const auto BAR = g_pGlobalState->pressedBar.lock())
+        BAR->onTouchUp(info, e);
+}
+
+static void onTouchMove(SCallbackInfo& info, ITouch::SMotionEvent e) {
+    if (const auto BAR = g_pGlobalState->pressedBar.lock())
+        BAR->onTouchMove(info, e);
+}
+
+static void onMouseMove(Vector2D coords) {
+    static auto* const PICONONHOVER = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:icon_on_hover")->getDataStaticPtr();
+
+    // ensure proper redraws of button icons on hover when using hardware cursors. The bar the cursor
+    // left needs one as well, to hide its icons again.
+    if (**PICONONHOVER) {
+        const auto HOVERED = barForWindow(g_pCompositor->vectorToWindowUnified(coords, RESERVED_EXTENTS | INPUT_EXTENTS | ALLOW_FLOATING));
+
+        if (const auto PREV = g_pGlobalState->hoveredBar.lock(); PREV && PREV.get() != HOVERED)
+            PREV->damageOnButtonHover();
+
+        if (HOVERED)
+            HOVERED->damageOnButtonHover();
+
+        g_pGlobalState->hoveredBar = HOVERED ? HOVERED->m_self : WP<CHyprBar>{};
+    }
+
+    if (const auto BAR = g_pGlobalState->pressedBar.lock())
+        BAR->onMouseMove(coords);
+}
+
 static void onCloseWindow(void* self, std::any data) {
     // data is guaranteed
     const auto PWINDOW = std::any_cast<PHLWINDOW>(data);
@@ -46,8 +147,140 @@ static void onCloseWindow(void* self, std::any data) {
     PWINDOW->removeWindowDeco(BARIT->get());
 }
 
+static SBarSettings currentSettings() {
+    static auto* const PENABLED       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:enabled")->getDataStaticPtr();
+    static auto* const PHEIGHT        = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_height")->getDataStaticPtr();
+    static auto* const PPRECEDENCE    = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_precedence_over_border")->getDataStaticPtr();
+    static auto* const PPART          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_part_of_window")->getDataStaticPtr();
+    static auto* const PCOLOR         = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_color")->getDataStaticPtr();
+    static auto* const PBLUR          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_blur")->getDataStaticPtr();
+    static auto* const PENABLETITLE   = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_title_enabled")->getDataStaticPtr();
+    static auto* const PTEXTCOLOR     = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:col.text")->getDataStaticPtr();
+    static auto* const PSIZE          = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_text_size")->getDataStaticPtr();
+    static auto* const PFONT          = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_text_font")->getDataStaticPtr();
+    static auto* const PALIGN         = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_text_align")->getDataStaticPtr();
+    static auto* const PALIGNBUTTONS  = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_buttons_alignment")->getDataStaticPtr();
+    static auto* const PPADDING       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_padding")->getDataStaticPtr();
+    static auto* const PBUTTONPADDING = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_button_padding")->getDataStaticPtr();
+    static auto* const PINACTIVECOLOR = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:inactive_button_color")->getDataStaticPtr();
+    static auto* const PTEXTENGINE    = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:text_engine")->getDataStaticPtr();
+
+    return {
+        .enabled              = **PENABLED,
+        .height               = **PHEIGHT,
+        .precedenceOverBorder = **PPRECEDENCE,
+        .partOfWindow         = **PPART,
+        .barColor             = **PCOLOR,
+        .blur                 = **PBLUR,
+        .titleEnabled         = **PENABLETITLE,
+        .textColor            = **PTEXTCOLOR,
+        .textSize             = **PSIZE,
+        .textFont             = *PFONT,
+        .textAlign            = *PALIGN,
+        .buttonsAlignment     = *PALIGNBUTTONS,
+        .padding              = **PPADDING,
+        .buttonPadding        = **PBUTTONPADDING,
+        .inactiveButtonColor  = **PINACTIVECOLOR,
+        .textEngine           = *PTEXTENGINE,
+    };
+}
+
+// what going from one set of settings to the other means for every bar, see eBarRuleDiff
+static uint8_t diffSettings(const SBarSettings& prev, const SBarSettings& next) {
+    uint8_t diff = BAR_RULE_DIFF_NONE;
+
+    if (prev.enabled != next.enabled || prev.precedenceOverBorder != next.precedenceOverBorder || prev.partOfWindow != next.partOfWindow)
+        diff |= BAR_RULE_DIFF_GEOMETRY;
+
+    // the title and the buttons are laid out in the bar's height
+    if (prev.height != next.height)
+        diff |= BAR_RULE_DIFF_GEOMETRY | BAR_RULE_DIFF_TITLE | BAR_RULE_DIFF_BUTTONS;
+
+    if (prev.barColor != next.barColor || prev.blur != next.blur)
+        diff |= BAR_RULE_DIFF_COLORS;
+
+    if (prev.titleEnabled != next.titleEnabled || prev.textColor != next.textColor || prev.textSize != next.textSize || prev.textFont != next.textFont ||
+        prev.textAlign != next.textAlign || prev.textEngine != next.textEngine)
+        diff |= BAR_RULE_DIFF_TITLE;
+
+    // the title is laid out around the buttons
+    if (prev.buttonsAlignment != next.buttonsAlignment || prev.padding != next.padding || prev.buttonPadding != next.buttonPadding)
+        diff |= BAR_RULE_DIFF_BUTTONS | BAR_RULE_DIFF_TITLE;
+
+    if (prev.inactiveButtonColor != next.inactiveButtonColor)
+        diff |= BAR_RULE_DIFF_BUTTONS;
+
+    return diff;
+}
+
+// without a user foreground, the icon color is picked from the background
+static bool sameIcon(const SHyprButton& a, const SHyprButton& b) {
+    return a.icon == b.icon && a.size == b.size && a.userfg == b.userfg && (a.userfg ? a.fgcol == b.fgcol : a.bgcol == b.bgcol);
+}
+
+static bool sameButton(const SHyprButton& a, const SHyprButton& b) {
+    return sameIcon(a, b) && a.bgcol == b.bgcol && a.action.dispatcher == b.action.dispatcher && a.action.arg == b.action.arg;
+}
+
+static void invalidateBars(uint8_t diff) {
+    if (diff == BAR_RULE_DIFF_NONE)
+        return;
+
+    for (auto& b : g_pGlobalState->bars) {
+        b->invalidate(diff);
+    }
+}
+
 static void onPreConfigReload() {
+    // kept until the reload is done, so unchanged buttons keep their icons
+    g_pGlobalState->previousButtons = std::move(g_pGlobalState->buttons);
     g_pGlobalState->buttons.clear();
+    g_pGlobalState->reloading = true;
+}
+
+static SDispatcherFn resolveDispatcher(const std::string& name) {
+    const auto IT = g_pKeybindManager->m_dispatchers.find(name);
+
+    if (IT == g_pKeybindManager->m_dispatchers.end())
+        throw std::runtime_error(std::format("[hb] No dispatcher named {}", name));
+
+    return IT->second;
+}
+
+static void setDoubleClickAction(const std::string& raw) {
+    auto action = parseBarAction(raw);
+
+    if (!action) {
+        HyprlandAPI::addNotification(PHANDLE, std::format("[hyprbars] invalid on_double_click: {}", action.error()), CHyprColor{1.0, 0.2, 0.2, 1.0}, 5000);
+        action = SBarAction{};
+    }
+
+    g_pGlobalState->doubleClickRaw    = raw;
+    g_pGlobalState->doubleClickAction = *action;
+}
+
+static void onConfigReloaded() {
+    static auto* const PONDOUBLECLICK = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:on_double_click")->getDataStaticPtr();
+
+    setDoubleClickAction(*PONDOUBLECLICK);
+
+    // everything the reload changed is applied to the bars at once
+    const auto SETTINGS = currentSettings();
+    uint8_t    diff     = diffSettings(g_pGlobalState->settings, SETTINGS);
+
+    if (!std::ranges::equal(g_pGlobalState->previousButtons, g_pGlobalState->buttons, sameButton))
+        diff |= BAR_RULE_DIFF_BUTTONS | BAR_RULE_DIFF_TITLE;
+
+    g_pGlobalState->settings = SETTINGS;
+    g_pGlobalState->previousButtons.clear();
+    g_pGlobalState->reloading = false;
+
+    invalidateBars(diff);
+}
+
+// a window that may cover bars came or went, or it may cover them now or not anymore, see occludersFor
+static void onOccludersChanged() {
+    g_pGlobalState->occluderWindowsDirty = true;
 }
 
 static void onUpdateWindowRules(PHLWINDOW window) {
@@ -56,56 +289,147 @@ static void onUpdateWindowRules(PHLWINDOW window) {
     if (BARIT == g_pGlobalState->bars.end())
         return;
 
-    (*BARIT)->updateRules();
-    window->updateWindowDecos();
+    const auto DIFF = (*BARIT)->updateRules();
+
+    if (DIFF == BAR_RULE_DIFF_NONE)
+        return;
+
+    if (DIFF & BAR_RULE_DIFF_GEOMETRY) {
+        g_pDecorationPositioner->repositionDeco(BARIT->get());
+        window->updateWindowDecos();
+        return;
+    }
+
+    (*BARIT)->damageEntire();
 }
 
-Hyprlang::CParseResult onNewButton(const char* K, const char* V) {
-    std::string            v = V;
-    CVarList               vars(v);
+constexpr size_t                    PENDING_BATCH_SIZE = 16;
+constexpr std::chrono::milliseconds PENDING_BATCH_DELAY{5};
 
-    Hyprlang::CParseResult result;
+static void attachPending(PHLWINDOW window) {
+    if (!window || window->isHidden() || !window->m_isMapped)
+        return;
 
-    // hyprbars-button = bgcolor, size, icon, action, fgcolor
+    onNewWindow(nullptr /* unused */, std::any(window));
+    onUpdateWindowRules(window);
+}
 
-    if (vars[0].empty() || vars[1].empty()) {
-        result.setError("bgcolor and size cannot be empty");
-        return result;
+static void onPendingTimer(SP<CEventLoopTimer> self, void* data) {
+    auto&      pending = g_pGlobalState->pendingWindows;
+    const auto COUNT   = std::min(pending.size(), PENDING_BATCH_SIZE);
+
+    for (size_t i = 0; i < COUNT; ++i) {
+        attachPending(pending[i].lock());
     }
 
-    float size = 10;
-    try {
-        size = std::stof(vars[1]);
-    } catch (std::exception& e) {
-        result.setError("failed to parse size");
-        return result;
+    pending.erase(pending.begin(), pending.begin() + COUNT);
+
+    if (!pending.empty())
+        self->updateTimeout(PENDING_BATCH_DELAY);
+}
+
+static void onPreRender(PHLMONITOR pMonitor) {
+    static auto* const PENABLED       = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:enabled")->getDataStaticPtr();
+    static auto* const PHEIGHT        = (Hyprlang::INT* const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:bar_height")->getDataStaticPtr();
+    static auto* const PONDOUBLECLICK = (Hyprlang::STRING const*)HyprlandAPI::getConfigValue(PHANDLE, "plugin:hyprbars:on_double_click")->getDataStaticPtr();
+
+    // hyprctl keyword changes values without a reload. Of those, turning the bars on or off and
+    // resizing them change the layout and have to be applied right away, everything else shows up
+    // on the next re-render or reload. on_double_click is never drawn, only parsed, so it's
+    // picked up here as well.
+    if (!g_pGlobalState->reloading && g_pGlobalState->doubleClickRaw != *PONDOUBLECLICK)
+        setDoubleClickAction(*PONDOUBLECLICK);
+
+    if (!g_pGlobalState->reloading && (**PENABLED != g_pGlobalState->settings.enabled || **PHEIGHT != g_pGlobalState->settings.height)) {
+        auto next    = g_pGlobalState->settings;
+        next.enabled = **PENABLED;
+        next.height  = **PHEIGHT;
+
+        const auto DIFF          = diffSettings(g_pGlobalState->settings, next);
+        g_pGlobalState->settings = next;
+        invalidateBars(DIFF);
     }
 
-    bool userfg  = false;
-    auto fgcolor = configStringToInt("rgb(ffffff)");
-    auto bgcolor = configStringToInt(vars[0]);
+    // a workspace switched to before its batch came up gets its bars before it's shown
+    if (!g_pGlobalState->pendingWindows.empty()) {
+        std::erase_if(g_pGlobalState->pendingWindows, [](const PHLWINDOWREF& w) {
+            const auto PWINDOW = w.lock();
 
-    if (!bgcolor) {
-        result.setError("invalid bgcolor");
-        return result;
+            if (PWINDOW && (!PWINDOW->m_workspace || !PWINDOW->m_workspace->isVisible()))
+                return false;
+
+            attachPending(PWINDOW);
+            return true;
+        });
     }
 
-    if (vars.size() == 5) {
-        userfg  = true;
-        fgcolor = configStringToInt(vars[4]);
+    if (!g_pGlobalState->pendingTouchDrags.empty()) {
+        // applying a drag can relayout and queue more, those wait for the next frame
+        const auto DRAGS = std::move(g_pGlobalState->pendingTouchDrags);
+        g_pGlobalState->pendingTouchDrags.clear();
+
+        for (const auto& b : DRAGS) {
+            if (const auto BAR = b.lock())
+                BAR->applyTouchDrag();
+        }
     }
 
-    if (!fgcolor) {
-        result.setError("invalid fgcolor");
-        return result;
+    // after the drags, they move windows
+    g_pGlobalState->frame++;
+}
+
+static void onRender(eRenderStage stage) {
+    if (stage == RENDER_PRE) {
+        TRACE_INSTANT("frame");
+        g_pBarStats->onFrame();
+        g_pTextureResidency->onFrame();
+    } else if (stage == RENDER_LAST_MOMENT)
+        g_pBarStats->renderOverlay();
+}
+
+static std::string onHyprCtl(eHyprCtlOutputFormat format, std::string request) {
+    CVarList vars(request, 0, ' ');
+
+    if (vars[1] == "stats") {
+        if (vars[2] == "reset") {
+            g_pBarStats->reset();
+            return "ok";
+        }
+
+        return g_pBarStats->describe(format == eHyprCtlOutputFormat::FORMAT_JSON);
     }
 
-    g_pGlobalState->buttons.push_back(SHyprButton{vars[3], userfg, *fgcolor, *bgcolor, size, vars[2]});
+    if (vars[1] == "textures")
+        return g_pTextureResidency->describe(format == eHyprCtlOutputFormat::FORMAT_JSON);
 
-    for (auto& b : g_pGlobalState->bars) {
-        b->m_bButtonsDirty = true;
+    return "unknown request, usage: hyprbars stats [reset] | textures";
+}
+
+Hyprlang::CParseResult onNewButton(const char* K, const char* V) {
+    std::string            v = V;
+    CVarList               vars(v);
+
+    Hyprlang::CParseResult result;
+
+    // hyprbars-button = bgcolor, size, icon, action, fgcolor
+    auto button = parseHyprButton(std::vector<std::string>{vars.begin(), vars.end()});
+
+    if (!button) {
+        result.setError(button.error().c_str());
+        return result;
     }
 
+    // an identical icon from before the reload is already rendered
+    const auto& PREV = g_pGlobalState->previousButtons;
+    if (const auto IT = std::ranges::find_if(PREV, [&](const auto& b) { return sameIcon(b, *button); }); IT != PREV.end())
+        button->iconTextures = IT->iconTextures;
+
+    g_pGlobalState->buttons.emplace_back(std::move(*button));
+
+    // during a reload, onConfigReloaded compares all the buttons at once
+    if (!g_pGlobalState->reloading)
+        invalidateBars(BAR_RULE_DIFF_BUTTONS | BAR_RULE_DIFF_TITLE);
+
     return result;
 }
 
@@ -123,6 +447,13 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 
     g_pGlobalState = makeUnique<SGlobalState>();
 
+    g_pGlobalState->dispatchers = {
+        .mouse       = resolveDispatcher("mouse"),
+        .setFloating = resolveDispatcher("setfloating"),
+        .setTiled    = resolveDispatcher("settiled"),
+        .pin         = resolveDispatcher("pin"),
+    };
+
     static auto P = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow", [&](void* self, SCallbackInfo& info, std::any data) { onNewWindow(self, data); });
     // static auto P2 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "closeWindow", [&](void* self, SCallbackInfo& info, std::any data) { onCloseWindow(self, data); });
     static auto P3 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "windowUpdateRules",
@@ -145,26 +476,83 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:icon_on_hover", Hyprlang::INT{0});
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:inactive_button_color", Hyprlang::INT{0}); // unset
     HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:on_double_click", Hyprlang::STRING{""});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:stats", Hyprlang::INT{0});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:texture_budget_mb", Hyprlang::INT{32});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:text_engine", Hyprlang::STRING{"pango"});
+    HyprlandAPI::addConfigValue(PHANDLE, "plugin:hyprbars:title_refresh_rate", Hyprlang::INT{10});
+
+    g_pBarStats         = makeUnique<CBarStats>();
+    g_pTextureResidency = makeUnique<CTextureResidency>();
 
     HyprlandAPI::addConfigKeyword(PHANDLE, "hyprbars-button", onNewButton, Hyprlang::SHandlerOptions{});
     static auto P4 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "preConfigReload", [&](void* self, SCallbackInfo& info, std::any data) { onPreConfigReload(); });
-
-    // add deco to existing windows
+    static auto P5 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "render", [&](void* self, SCallbackInfo& info, std::any data) { onRender(std::any_cast<eRenderStage>(data)); });
+    static auto P6 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "configReloaded", [&](void* self, SCallbackInfo& info, std::any data) { onConfigReloaded(); });
+    static auto P7 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "preRender", [&](void* self, SCallbackInfo& info, std::any data) { onPreRender(std::any_cast<PHLMONITOR>(data)); });
+    static auto P8 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "activeWindow", [&](void* self, SCallbackInfo& info, std::any data) { onActiveWindow(std::any_cast<PHLWINDOW>(data)); });
+    static auto P9 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "windowTitle", [&](void* self, SCallbackInfo& info, std::any data) { onWindowTitle(std::any_cast<PHLWINDOW>(data)); });
+
+    // input, for all bars at once
+    static auto P10 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "mouseButton", [&](void* self, SCallbackInfo& info, std::any data) { onMouseButton(info, std::any_cast<IPointer::SButtonEvent>(data)); });
+    static auto P11 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "touchDown", [&](void* self, SCallbackInfo& info, std::any data) { onTouchDown(info, std::any_cast<ITouch::SDownEvent>(data)); });
+    static auto P12 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "touchUp", [&](void* self, SCallbackInfo& info, std::any data) { onTouchUp(info, std::any_cast<ITouch::SUpEvent>(data)); });
+    static auto P13 = HyprlandAPI::registerCallbackDynamic(
+        PHANDLE, "touchMove", [&](void* self, SCallbackInfo& info, std::any data) { onTouchMove(info, std::any_cast<ITouch::SMotionEvent>(data)); });
+    static auto P14 =
+        HyprlandAPI::registerCallbackDynamic(PHANDLE, "mouseMove", [&](void* self, SCallbackInfo& info, std::any data) { onMouseMove(std::any_cast<Vector2D>(data)); });
+
+    // the windows that can cover bars, see occludersFor
+    static auto P15 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "openWindow", [&](void* self, SCallbackInfo& info, std::any data) { onOccludersChanged(); });
+    static auto P16 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "closeWindow", [&](void* self, SCallbackInfo& info, std::any data) { onOccludersChanged(); });
+    static auto P17 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "changeFloatingMode", [&](void* self, SCallbackInfo& info, std::any data) { onOccludersChanged(); });
+    static auto P18 = HyprlandAPI::registerCallbackDynamic(PHANDLE, "fullscreen", [&](void* self, SCallbackInfo& info, std::any data) { onOccludersChanged(); });
+
+    HyprlandAPI::registerHyprCtlCommand(PHANDLE, SHyprCtlCommand{.name = "hyprbars", .exact = false, .fn = onHyprCtl});
+
+    // add deco to existing windows. Visible ones get theirs right away, the rest is attached
+    // in small batches from the event loop so loading the plugin doesn't stall on big sessions.
     for (auto& w : g_pCompositor->m_windows) {
         if (w->isHidden() || !w->m_isMapped)
             continue;
 
+        if (w->m_workspace && !w->m_workspace->isVisible()) {
+            g_pGlobalState->pendingWindows.emplace_back(w);
+            continue;
+        }
+
         onNewWindow(nullptr /* unused */, std::any(w));
     }
 
     HyprlandAPI::reloadConfig();
 
+    if (!g_pGlobalState->pendingWindows.empty()) {
+        g_pGlobalState->pendingTimer = makeShared<CEventLoopTimer>(PENDING_BATCH_DELAY, onPendingTimer, nullptr);
+        g_pEventLoopManager->addTimer(g_pGlobalState->pendingTimer);
+    }
+
     return {"hyprbars", "A plugin to add title bars to windows.", "Vaxry", "1.0"};
 }
 
 APICALL EXPORT void PLUGIN_EXIT() {
+    if (g_pGlobalState->pendingTimer)
+        g_pEventLoopManager->removeTimer(g_pGlobalState->pendingTimer);
+
     for (auto& m : g_pCompositor->m_monitors)
         m->m_scheduledRecalc = true;
 
     g_pHyprRenderer->m_renderPass.removeAllOfType("CBarPassElement");
+
+    g_pGlyphRenderer.reset();
+    g_pTextureResidency.reset();
+    g_pBarStats.reset();
+
+    g_pGlobalState->rasterSurfaces.clear();
+
+    TRACE_FLUSH();
 }
@@ -0,0 +1,59 @@
+// Checks every swizzle kernel the cpu can run against the scalar one. Run by ctest, meson test and
+// make test, see bench/swizzle.cpp for their throughput.
+
+#include "../Swizzle.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <print>
+#include <random>
+#include <vector>
+
+// odd widths and strides with padding hit the row tails and unaligned loads
+static bool check(const Swizzle::SKernel& kernel) {
+    std::mt19937 rng(42);
+
+    for (const size_t WIDTH : {1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 64, 401, 1203}) {
+        for (const size_t PADDING : {0, 4, 12}) {
+            const size_t         HEIGHT = 3;
+            const size_t         STRIDE = WIDTH * 4 + PADDING;
+
+            std::vector<uint8_t> src(STRIDE * HEIGHT);
+            for (auto& b : src) {
+                b = rng();
+            }
+
+            std::vector<uint8_t> expected(src.size(), 0), got(src.size(), 0);
+            Swizzle::bgraToRgbaScalar(src.data(), STRIDE, expected.data(), STRIDE, WIDTH, HEIGHT);
+            kernel.fn(src.data(), STRIDE, got.data(), STRIDE, WIDTH, HEIGHT);
+
+            if (got != expected) {
+                std::println(stderr, "swizzle mismatch: kernel {} width {} padding {}", kernel.name, WIDTH, PADDING);
+                return false;
+            }
+
+            // in place, like the upload path does it
+            kernel.fn(src.data(), STRIDE, src.data(), STRIDE, WIDTH, HEIGHT);
+            for (size_t y = 0; y < HEIGHT; ++y) {
+                if (!std::equal(src.begin() + y * STRIDE, src.begin() + y * STRIDE + WIDTH * 4, expected.begin() + y * STRIDE)) {
+                    std::println(stderr, "in place swizzle mismatch: kernel {} width {} padding {}", kernel.name, WIDTH, PADDING);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    bool ok = true;
+    for (const auto& kernel : Swizzle::kernels()) {
+        if (!check(kernel))
+            ok = false;
+        else
+            std::println("{}: ok", kernel.name);
+    }
+
+    return ok ? 0 : 1;
+}
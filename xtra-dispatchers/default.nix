@@ -6,7 +6,12 @@
 hyprlandPlugins.mkHyprlandPlugin {
   pluginName = "xtra-dispatchers";
   version = "0.1";
-  src = ./.;
+  # common/ holds the headers shared between plugins
+  src = lib.fileset.toSource {
+    root = ./..;
+    fileset = lib.fileset.unions [./. ../common];
+  };
+  sourceRoot = "source/xtra-dispatchers";
 
   inherit (hyprland) nativeBuildInputs;
 
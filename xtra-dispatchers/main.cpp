@@ -17,6 +17,7 @@
 using namespace Hyprutils::String;
 
 #include "globals.hpp"
+#include "../common/Trace.hpp"
 
 // Do NOT change this function.
 APICALL EXPORT std::string PLUGIN_API_VERSION() {
@@ -26,6 +27,8 @@ APICALL EXPORT std::string PLUGIN_API_VERSION() {
 //
 
 static SDispatchResult moveOrExec(std::string in) {
+    TRACE_ZONE("plugin:xtd:moveorexec");
+
     CVarList vars(in, 0, ',');
 
     if (!g_pCompositor->m_lastMonitor || !g_pCompositor->m_lastMonitor->m_activeWorkspace)
@@ -47,6 +50,8 @@ static SDispatchResult moveOrExec(std::string in) {
 }
 
 static SDispatchResult throwUnfocused(std::string in) {
+    TRACE_ZONE("plugin:xtd:throwunfocused");
+
     const auto [id, name, isAutoID] = getWorkspaceIDNameFromString(in);
 
     if (id == WORKSPACE_INVALID)
@@ -70,6 +75,8 @@ static SDispatchResult throwUnfocused(std::string in) {
 }
 
 static SDispatchResult bringAllFrom(std::string in) {
+    TRACE_ZONE("plugin:xtd:bringallfrom");
+
     const auto [id, name, isAutoID] = getWorkspaceIDNameFromString(in);
 
     if (id == WORKSPACE_INVALID)
@@ -100,6 +107,8 @@ static SDispatchResult bringAllFrom(std::string in) {
 }
 
 static SDispatchResult closeUnfocused(std::string in) {
+    TRACE_ZONE("plugin:xtd:closeunfocused");
+
     if (!g_pCompositor->m_lastMonitor)
         return SDispatchResult{.success = false, .error = "No focused monitor"};
 
@@ -142,5 +151,5 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 }
 
 APICALL EXPORT void PLUGIN_EXIT() {
-    ;
+    TRACE_FLUSH();
 }